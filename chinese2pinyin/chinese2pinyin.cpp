@@ -27,62 +27,117 @@
 // in the LICENSE file.
 
 #include "chinese2pinyin.h"
+#include "pinyin_table.h"
 
-#include <QHash>
-#include <QTextStream>
-#include <QFile>
+#include <string.h>
 
 namespace Pinyin {
 
-static QHash<uint, QString> dict = {};
+// returns the pinyin with the tone number
+static inline const char *Find(uint ucs4, int *length) {
+    // the code points before kTableFirst wrap around
+    const uint index = ucs4 - kTableFirst;
 
-const char kDictFile[] = ":/misc/pinyin.dict";
-
-void InitDict() {
-    if (!dict.isEmpty()) {
-        return;
+    if (index >= kTableCount || kTableIndex[index] == 0) {
+        return nullptr;
     }
 
-    dict.reserve(25333);
+    *length = int(kTableIndex[index] & 0xff);
 
-    QFile file(kDictFile);
+    return kTableData + (kTableIndex[index] >> 8);
+}
 
-    if (!file.open(QIODevice::ReadOnly))
-        return;
+QString Chinese2Pinyin(const QString& words) {
+    QString result;
 
-    QByteArray content = file.readAll();
+    for (int i = 0; i < words.length(); ++i) {
+        const uint key = words.at(i).unicode();
+        int length = 0;
+        const char *pinyin = Find(key, &length);
 
-    file.close();
+        if (pinyin) {
+            result.append(QLatin1String(pinyin, length));
+        } else {
+            result.append(words.at(i));
+        }
+    }
 
-    QTextStream stream(&content, QIODevice::ReadOnly);
+    return result;
+}
 
-    while (!stream.atEnd()) {
-        const QString line = stream.readLine();
-        const QStringList items = line.split(QChar(':'));
+const char *Lookup(uint ucs4, int *length) {
+    const char *pinyin = Find(ucs4, length);
 
-        if (items.size() == 2) {
-            dict.insert(items[0].toInt(nullptr, 16), items[1]);
-        }
+    // strip the tone number
+    if (pinyin) {
+        --*length;
     }
+
+    return pinyin;
 }
 
-QString Chinese2Pinyin(const QString& words) {
-    InitDict();
+bool Transliterate(const char *utf8, int length,
+                   char *pinyin, int pinyinCapacity, int *pinyinLength,
+                   char *initials, int initialsCapacity, int *initialsLength) {
+    const uchar *text = reinterpret_cast<const uchar *>(utf8);
+    bool found = false;
+    int p = 0;
+    int n = 0;
+
+    for (int i = 0; i < length;) {
+        const uchar c = text[i];
+        uint ucs4 = c;
+        int size = 1;
+
+        if (c >= 0xe0 && c < 0xf0 && i + 2 < length) {
+            ucs4 = ((c & 0x0fu) << 12) | ((text[i + 1] & 0x3fu) << 6) | (text[i + 2] & 0x3fu);
+            size = 3;
+        } else if (c >= 0xc0 && c < 0xe0 && i + 1 < length) {
+            ucs4 = ((c & 0x1fu) << 6) | (text[i + 1] & 0x3fu);
+            size = 2;
+        } else if (c >= 0xf0 && i + 3 < length) {
+            size = 4;
+        }
 
-    QString result;
+        int pinyin_length = 0;
+        const char *value = ucs4 >= 0x80 ? Find(ucs4, &pinyin_length) : nullptr;
 
-    for (int i = 0; i < words.length(); ++i) {
-        const uint key = words.at(i).unicode();
-        auto find_result = dict.find(key);
+        if (value) {
+            // without the tone number
+            --pinyin_length;
+
+            if (p + pinyin_length > pinyinCapacity || n + 1 > initialsCapacity) {
+                return false;
+            }
 
-        if (find_result != dict.end()) {
-            result.append(find_result.value());
+            memcpy(pinyin + p, value, size_t(pinyin_length));
+            p += pinyin_length;
+            initials[n++] = value[0];
+            found = true;
         } else {
-            result.append(words.at(i));
+            if (p + size > pinyinCapacity || n + size > initialsCapacity) {
+                return false;
+            }
+
+            for (int j = 0; j < size; ++j) {
+                char ch = utf8[i + j];
+
+                if (ch >= 'A' && ch <= 'Z') {
+                    ch += 'a' - 'A';
+                }
+
+                pinyin[p++] = ch;
+                initials[n++] = ch;
+            }
         }
+
+        i += size;
     }
 
-    return result;
+    *pinyinLength = p;
+    *initialsLength = n;
+
+    return found;
 }
 
 }  // namespace Pinyin end
@@ -33,6 +33,17 @@
 
 namespace Pinyin {
 QString Chinese2Pinyin(const QString& words);
+
+// Returns the lower case pinyin without tone of the character, or nullptr if it
+// is not a chinese character. The data is owned by the table, don't free it.
+const char *Lookup(uint ucs4, int *length);
+
+// Converts the utf-8 text to pinyin without tones and to the initials of the pinyin,
+// other characters are copied and ascii letters are lower-cased. No memory is
+// allocated, returns false if the buffers are too small or no chinese character was found.
+bool Transliterate(const char *utf8, int length,
+                   char *pinyin, int pinyinCapacity, int *pinyinLength,
+                   char *initials, int initialsCapacity, int *initialsLength);
 };
 
 #endif  // SERVICE_BACKEND_CHINESE2PINYIN_H_
@@ -4,7 +4,11 @@ HEADERS += \
 SOURCES += \
     $$PWD/chinese2pinyin.cpp
 
-RESOURCES += \
-    $$PWD/data.qrc
+# the dictionary is compiled into a lookup table, it is not loaded at runtime
+!system($$PWD/generate_table.sh $$PWD/pinyin.dict $$OUT_PWD/chinese2pinyin/pinyin_table.h): error("Failed to generate pinyin table")
 
-INCLUDEPATH += $$PWD
+OTHER_FILES += \
+    $$PWD/pinyin.dict \
+    $$PWD/generate_table.sh
+
+INCLUDEPATH += $$PWD $$OUT_PWD/chinese2pinyin
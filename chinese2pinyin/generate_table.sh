@@ -0,0 +1,125 @@
+#!/bin/sh
+# this file is used to auto-generate the pinyin lookup table from pinyin.dict.
+# usage: generate_table.sh <pinyin.dict> <output header>
+
+dict=$1
+output=$2
+
+if [ -z "$dict" ] || [ -z "$output" ]; then
+    echo "usage: $0 <pinyin.dict> <output header>" >&2
+    exit 1
+fi
+
+# the dictionary is not changed since the last generation
+if [ -f "$output" ] && [ "$output" -nt "$dict" ] && [ "$output" -nt "$0" ]; then
+    exit 0
+fi
+
+mkdir -p "$(dirname "$output")" || exit 1
+
+awk -F: '
+function hex(s,    i, c, n) {
+    s = tolower(s)
+    sub(/^0x/, "", s)
+    n = 0
+
+    for (i = 1; i <= length(s); ++i) {
+        c = index("0123456789abcdef", substr(s, i, 1))
+
+        if (c == 0)
+            return -1
+
+        n = n * 16 + c - 1
+    }
+
+    return n
+}
+
+BEGIN {
+    first = -1
+    last = -1
+    size = 0
+    value_count = 0
+}
+
+NF >= 2 {
+    key = hex($1)
+    value = $2
+    gsub(/[ \t\r]/, "", value)
+
+    if (key < 0 || value == "" || length(value) > 255)
+        next
+
+    # the values are shared by many characters, store each one only once
+    if (!(value in offsets)) {
+        offsets[value] = size
+        values[value_count++] = value
+        size += length(value)
+    }
+
+    table[key] = offsets[value] * 256 + length(value)
+
+    if (first < 0 || key < first)
+        first = key
+
+    if (key > last)
+        last = key
+}
+
+END {
+    if (first < 0)
+        exit 1
+
+    count = last - first + 1
+
+    print "// generated from pinyin.dict by generate_table.sh, do not edit."
+    print ""
+    print "#ifndef PINYIN_TABLE_H"
+    print "#define PINYIN_TABLE_H"
+    print ""
+    print "#include <QtGlobal>"
+    print ""
+    print "namespace Pinyin {"
+    print ""
+    printf "constexpr uint kTableFirst = 0x%x;\n", first
+    printf "constexpr uint kTableCount = %d;\n", count
+    print ""
+    print "// offset of the pinyin in kTableData << 8 | length of the pinyin,"
+    print "// 0 if the code point has no pinyin. indexed by code point - kTableFirst."
+    print "constexpr quint32 kTableIndex[kTableCount] = {"
+
+    line = ""
+
+    for (i = 0; i < count; ++i) {
+        item = (first + i) in table ? sprintf("0x%x", table[first + i]) : "0"
+        line = line item ","
+
+        if (i % 12 == 11 || i == count - 1) {
+            print "    " line
+            line = ""
+        } else {
+            line = line " "
+        }
+    }
+
+    print "};"
+    print ""
+    print "// the pinyin with the tone number, without separator"
+    print "constexpr char kTableData[] ="
+
+    line = ""
+
+    for (i = 0; i < value_count; ++i) {
+        line = line values[i]
+
+        if (length(line) >= 72 || i == value_count - 1) {
+            printf "    \"%s\"%s\n", line, i == value_count - 1 ? ";" : ""
+            line = ""
+        }
+    }
+
+    print ""
+    print "}"
+    print ""
+    print "#endif // PINYIN_TABLE_H"
+}' "$dict" > "$output.tmp" && mv "$output.tmp" "$output"
@@ -1162,30 +1162,12 @@ QString AppController::createFile(const QString &sourceFile, const QString &targ
 
 AppController::AppController(QObject *parent) : QObject(parent)
 {
-    createGVfSManager();
-    createUserShareManager();
+    // the network, secret and user share managers are created by the applications,
+    // after the first window is shown, see DFMGlobal::initSecretManager
     createDBusInterface();
-    initConnect();
     registerUrlHandle();
 }
 
-void AppController::initConnect()
-{
-    connect(userShareManager, &UserShareManager::userShareCountChanged,
-            fileSignalManager, &FileSignalManager::userShareCountChanged);
-}
-
-void AppController::createGVfSManager()
-{
-    networkManager;
-    secretManager;
-}
-
-void AppController::createUserShareManager()
-{
-    userShareManager;
-}
-
 void AppController::createDBusInterface()
 {
     m_startManagerInterface = new StartManagerInterface("com.deepin.SessionManager",
@@ -151,9 +151,6 @@ protected:
     explicit AppController(QObject *parent = 0);
 
 private:
-    void initConnect();
-    void createGVfSManager();
-    void createUserShareManager();
     void createDBusInterface();
 
     QSharedPointer<DFMEvent> m_fmEvent;
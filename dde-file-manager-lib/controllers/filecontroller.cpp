@@ -47,7 +47,7 @@
 
 #include "shutil/fileutils.h"
 #include "shutil/dfmregularexpression.h"
-#include "shutil/dfmfilelistfile.h"
+#include "shutil/dfmhiddenfilecache.h"
 
 #include "dialogs/dialogmanager.h"
 #include "dialogs/dtaskdialog.h"
@@ -312,7 +312,7 @@ public:
 
     bool enableIteratorByKeyword(const QString &keyword) Q_DECL_OVERRIDE;
 
-    DFMFileListFile * hiddenFiles = nullptr;
+    DFMHiddenFileCache::HiddenNames hiddenFiles;
 
 private:
     DDirIterator *iterator = nullptr;
@@ -516,10 +516,20 @@ static DUrlList pasteFilesV2(DFMGlobal::ClipboardAction action, const DUrlList &
     DFileCopyMoveJob *job = new DFileCopyMoveJob();
     QPair<DUrl, DUrl> currentJob;
 
+    DFileCopyMoveJob::FileHints hints;
+
     if (force) {
-        job->setFileHints(DFileCopyMoveJob::ForceDeleteFile);
+        hints |= DFileCopyMoveJob::ForceDeleteFile;
+    }
+
+    // the page cache of a network or fuse target is not the data on the server,
+    // read the files back from it to check them
+    if (target.isLocalFile() && !DStorageInfo::isLocalDevice(target.toLocalFile())) {
+        hints |= DFileCopyMoveJob::VerifyFromMedia;
     }
 
+    job->setFileHints(hints);
+
     if (action == DFMGlobal::CutAction && !target.isValid()) {
         // for remove mode
         job->setActionOfErrorType(DFileCopyMoveJob::NonexistenceError, DFileCopyMoveJob::SkipAction);
@@ -1096,7 +1106,7 @@ FileDirIterator::FileDirIterator(const QString &path, const QStringList &nameFil
     }
 
     // misc, not related to the file iterator at all.
-    hiddenFiles = new DFMFileListFile(path);
+    hiddenFiles = DFMHiddenFileCache::instance()->hiddenNames(path);
 }
 
 FileDirIterator::~FileDirIterator()
@@ -1104,10 +1114,6 @@ FileDirIterator::~FileDirIterator()
     if (iterator) {
         delete iterator;
     }
-
-    if (hiddenFiles) {
-        delete hiddenFiles;
-    }
 }
 
 DUrl FileDirIterator::next()
@@ -1140,7 +1146,7 @@ bool FileDirIterator::hasNext() const
         const_cast<FileDirIterator *>(this)->iterator->next();
         info = iterator->fileInfo();
 
-        if (!info->isPrivate() && (showHidden || (!info->isHidden() && !hiddenFiles->contains(info->fileName())))) {
+        if (!info->isPrivate() && (showHidden || (!info->isHidden() && !hiddenFiles.contains(info->fileName())))) {
             break;
         }
 
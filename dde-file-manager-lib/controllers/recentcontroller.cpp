@@ -23,6 +23,7 @@
 #include "dfmevent.h"
 #include "dfmglobal.h"
 #include "private/dabstractfilewatcher_p.h"
+#include "shutil/dfmexecutor.h"
 
 #include <QFileSystemWatcher>
 #include <QXmlStreamReader>
@@ -478,5 +479,7 @@ void RecentController::asyncHandleFileChanged()
      * Applications using GTK does not trigger file closed/modified events
      * at all for some obscure reasons.
      */
-    QtConcurrent::run(this, &RecentController::handleFileChanged);
+    DFMExecutor::instance(DFMExecutor::LocalIO)->run([this] {
+        handleFileChanged();
+    });
 }
@@ -31,6 +31,8 @@
 #include "models/searchfileinfo.h"
 #include "ddiriterator.h"
 #include "shutil/dfmregularexpression.h"
+#include "dlocalsearchengine.h"
+#include "dfilenameindex.h"
 
 #include "app/define.h"
 #include "app/filesignalmanager.h"
@@ -259,6 +261,9 @@ public:
     mutable QList<DUrl> searchPathList;
     mutable DDirIteratorPointer it;
     mutable bool m_hasIteratorByKeywordOfCurrentIt;
+    // used for the local directories which are not indexed by anything
+    QScopedPointer<DFM_NAMESPACE::DLocalSearchEngine> localSearchEngine;
+    mutable bool localSearching = false;
 
 #ifndef DISABLE_QUICK_SEARCH
     // 所有支持快速搜索的子目录(可包含待搜索目录本身)
@@ -278,6 +283,7 @@ SearchDiriterator::SearchDiriterator(const DUrl &url, const QStringList &nameFil
     , m_nameFilters(nameFilters)
     , m_filter(filter)
     , m_flags(flags)
+    , localSearchEngine(new DFM_NAMESPACE::DLocalSearchEngine())
 {
     targetUrl = url.searchTargetUrl();
     keyword = DFMRegularExpression::checkWildcardAndToRegularExpression(url.searchKeyword());
@@ -346,6 +352,25 @@ bool SearchDiriterator::hasNext() const
             return false;
         }
 
+        if (localSearching) {
+            for (const DFM_NAMESPACE::DLocalSearchEngine::Match &match : localSearchEngine->takeMatches()) {
+                DUrl url = m_fileUrl;
+
+                url.setSearchedFileUrl(DUrl::fromLocalFile(QString::fromLocal8Bit(match.filePath)));
+                childrens << url;
+            }
+
+            if (!childrens.isEmpty()) {
+                return true;
+            }
+
+            if (localSearchEngine->isFinished()) {
+                localSearching = false;
+            }
+
+            continue;
+        }
+
         if (!it) {
             if (searchPathList.isEmpty()) {
                 break;
@@ -384,6 +409,43 @@ bool SearchDiriterator::hasNext() const
             {
                 m_hasIteratorByKeywordOfCurrentIt = it->enableIteratorByKeyword(m_fileUrl.searchKeyword());
             }
+
+            if (!m_hasIteratorByKeywordOfCurrentIt && url.isLocalFile()) {
+                DFM_NAMESPACE::DFileNameIndex *index = DFM_NAMESPACE::DFileNameIndex::instance();
+                const QString &path = url.toLocalFile();
+
+                if (index->isEnabled()) {
+                    if (index->isReady(path)) {
+                        for (const QByteArray &file : index->search(path, m_fileUrl.searchKeyword(), m_filter.testFlag(QDir::Hidden))) {
+                            DUrl url = m_fileUrl;
+
+                            url.setSearchedFileUrl(DUrl::fromLocalFile(QString::fromLocal8Bit(file)));
+                            childrens << url;
+                        }
+
+                        it.clear();
+
+                        if (!childrens.isEmpty()) {
+                            return true;
+                        }
+
+                        continue;
+                    }
+
+                    // the index will be used next time
+                    QMetaObject::invokeMethod(index, "prepare", Qt::QueuedConnection, Q_ARG(QString, path));
+                }
+
+                // walk the whole local tree with multiple threads, the names are matched
+                // before any file info is created
+                localSearchEngine->setShowHidden(m_filter.testFlag(QDir::Hidden));
+                localSearching = localSearchEngine->start(path, m_fileUrl.searchKeyword());
+
+                if (localSearching) {
+                    it.clear();
+                    continue;
+                }
+            }
         }
 
         while (it->hasNext()) {
@@ -457,6 +519,7 @@ DUrl SearchDiriterator::url() const
 void SearchDiriterator::close()
 {
     closed = true;
+    localSearchEngine->stop();
 }
 
 SearchController::SearchController(QObject *parent)
@@ -273,6 +273,9 @@ HEADERS += \
     plugins/dfmadditionalmenu.h \
     dialogs/connecttoserverdialog.h \
     shutil/dfmfilelistfile.h \
+    shutil/dfmhiddenfilecache.h \
+    shutil/dfmstartuptrace.h \
+    shutil/dfmexecutor.h \
     views/dfmsplitter.h
 
 SOURCES += \
@@ -462,6 +465,9 @@ SOURCES += \
     plugins/dfmadditionalmenu.cpp \
     dialogs/connecttoserverdialog.cpp \
     shutil/dfmfilelistfile.cpp \
+    shutil/dfmhiddenfilecache.cpp \
+    shutil/dfmstartuptrace.cpp \
+    shutil/dfmexecutor.cpp \
     views/dfmsplitter.cpp
 
 !CONFIG(DISABLE_ANYTHING) {
@@ -47,6 +47,13 @@
 #include <QProcess>
 #include <QStorageInfo>
 #include <QUrlQuery>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+// the device events in this interval are handled as one batch, plugging a hub
+// with many partitions emits dozens of them
+#define DISK_EVENT_INTERVAL 200
 
 
 class UDiskFileWatcher;
@@ -105,11 +112,146 @@ void UDiskListener::initConnect()
     connect(m_diskMgr, &DDiskManager::fileSystemRemoved, this, [this](const QString& path) {
         delete m_fsDevMap.take(path);
     });
-    connect(gvfsMountManager, &GvfsMountManager::mount_added, this, &UDiskListener::addMountDiskInfo);
-    connect(gvfsMountManager, &GvfsMountManager::mount_removed, this, &UDiskListener::removeMountDiskInfo);
-    connect(gvfsMountManager, &GvfsMountManager::volume_added, this, &UDiskListener::addVolumeDiskInfo);
-    connect(gvfsMountManager, &GvfsMountManager::volume_removed, this, &UDiskListener::removeVolumeDiskInfo);
-    connect(gvfsMountManager, &GvfsMountManager::volume_changed, this, &UDiskListener::changeVolumeDiskInfo);
+
+    m_diskInfoEventTimer = new QTimer(this);
+    m_diskInfoEventTimer->setSingleShot(true);
+    m_diskInfoEventTimer->setInterval(DISK_EVENT_INTERVAL);
+    connect(m_diskInfoEventTimer, &QTimer::timeout, this, &UDiskListener::processDiskInfoEvents);
+
+    connect(gvfsMountManager, &GvfsMountManager::mount_added, this, [this](const QDiskInfo &diskInfo) {
+        queueDiskInfoEvent(EventTypeMountAdded, diskInfo);
+    });
+    connect(gvfsMountManager, &GvfsMountManager::mount_removed, this, [this](const QDiskInfo &diskInfo) {
+        queueDiskInfoEvent(EventTypeMountRemoved, diskInfo);
+    });
+    connect(gvfsMountManager, &GvfsMountManager::volume_added, this, [this](const QDiskInfo &diskInfo) {
+        queueDiskInfoEvent(EventTypeVolumeAdded, diskInfo);
+    });
+    connect(gvfsMountManager, &GvfsMountManager::volume_removed, this, [this](const QDiskInfo &diskInfo) {
+        queueDiskInfoEvent(EventTypeVolumeRemoved, diskInfo);
+    });
+    connect(gvfsMountManager, &GvfsMountManager::volume_changed, this, [this](const QDiskInfo &diskInfo) {
+        queueDiskInfoEvent(EventTypeVolumeChanged, diskInfo);
+    });
+}
+
+void UDiskListener::queueDiskInfoEvent(int type, const QDiskInfo &diskInfo)
+{
+    m_diskInfoEvents.append(qMakePair(type, diskInfo));
+
+    // the timer isn't restarted, an event waits for one interval at most
+    if (!m_diskInfoEventTimer->isActive()) {
+        m_diskInfoEventTimer->start();
+    }
+}
+
+void UDiskListener::processDiskInfoEvents()
+{
+    const QList<QPair<int, QDiskInfo>> events = m_diskInfoEvents;
+    QList<QPair<int, QDiskInfo>> batch;
+    QHash<QString, int> nextTypes;
+
+    m_diskInfoEvents.clear();
+
+    // of the same events of a device in a row only the last one is kept
+    for (int i = events.size() - 1; i >= 0; --i) {
+        const QPair<int, QDiskInfo> &event = events.at(i);
+        const QString &key = event.second.id().isEmpty() ? event.second.uuid() : event.second.id();
+
+        if (!key.isEmpty() && nextTypes.value(key) == event.first) {
+            continue;
+        }
+
+        nextTypes[key] = event.first;
+        batch.prepend(event);
+    }
+
+    bool changed = false;
+
+    for (const QPair<int, QDiskInfo> &event : batch) {
+        const QDiskInfo &diskInfo = event.second;
+        const UDiskDeviceInfoPointer &device = m_map.value(diskInfo.id());
+
+        // the event which doesn't change the known device is dropped
+        const bool unchanged = device && device->getDiskInfo() == diskInfo;
+
+        switch (event.first) {
+        case EventTypeMountAdded:
+            // the volume changed event before it has stored the same disk info already,
+            // only a mount already handled at the same root is dropped
+            if (diskInfo.mounted_root_uri().isEmpty()
+                    || m_mountedRootUris.value(diskInfo.id()) != diskInfo.mounted_root_uri()) {
+                addMountDiskInfo(diskInfo);
+                changed = true;
+            }
+            break;
+        case EventTypeMountRemoved:
+            if (device) {
+                removeMountDiskInfo(diskInfo);
+                changed = true;
+            }
+            break;
+        case EventTypeVolumeAdded:
+            if (!unchanged) {
+                addVolumeDiskInfo(diskInfo);
+            }
+            break;
+        case EventTypeVolumeRemoved:
+            removeVolumeDiskInfo(diskInfo);
+            break;
+        case EventTypeVolumeChanged:
+            if (!unchanged) {
+                changeVolumeDiskInfo(diskInfo);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (changed) {
+        emit mountsChanged();
+    }
+}
+
+void UDiskListener::notifySubscribers(UDiskDeviceInfoPointer device)
+{
+    const QString &id = device->getId();
+    const QString &url = device->getMountPointUrl().toString();
+    const QList<Subscriber *> subscribers = m_subscribers;
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, subscribers] {
+        const QString &url = watcher->result();
+
+        watcher->deleteLater();
+
+        if (url.isEmpty()) {
+            return;
+        }
+
+        qDebug() << url;
+        foreach (Subscriber *sub, subscribers) {
+            // the subscriber may be removed meanwhile
+            if (m_subscribers.contains(sub)) {
+                sub->doSubscriberAction(url);
+            }
+        }
+    });
+
+    // finding out the drive takes a few blocking dbus calls
+    watcher->setFuture(QtConcurrent::run([id, url] {
+        QStringList devList = DDiskManager::resolveDeviceNode(id, {});
+        if (devList.isEmpty()) {
+            return QString();
+        }
+        QScopedPointer<DBlockDevice> blkdev(DDiskManager::createBlockDevice(devList.first()));
+        QScopedPointer<DDiskDevice> drive(DDiskManager::createDiskDevice(blkdev->drive()));
+        if (drive->optical()) {
+            return DUrl::fromBurnFile(id + "/" + BURN_SEG_ONDISC + "/").toString();
+        }
+        return url;
+    }));
 }
 
 UDiskDeviceInfoPointer UDiskListener::getDevice(const QString &id)
@@ -136,6 +278,7 @@ void UDiskListener::removeDevice(UDiskDeviceInfoPointer device)
 {
     m_list.removeOne(device);
     m_map.remove(device->getDiskInfo().id());
+    m_mountedRootUris.remove(device->getDiskInfo().id());
 
     DAbstractFileWatcher::ghostSignal(DUrl(DEVICE_ROOT),
                                       &DAbstractFileWatcher::fileDeleted,
@@ -206,6 +349,8 @@ void UDiskListener::update()
             addMountDiskInfo(diskInfo);
         }
     }
+
+    emit mountsChanged();
 }
 
 
@@ -452,6 +597,7 @@ void UDiskListener::addMountDiskInfo(const QDiskInfo &diskInfo)
     }
 
     if (!diskInfo.mounted_root_uri().isEmpty()) {
+        m_mountedRootUris[diskInfo.id()] = diskInfo.mounted_root_uri();
         DAbstractFileWatcher::ghostSignal(DUrl(DEVICE_ROOT),
                                           &DAbstractFileWatcher::fileAttributeChanged,
                                           DUrl::fromDeviceId(device->getId()));
@@ -459,17 +605,8 @@ void UDiskListener::addMountDiskInfo(const QDiskInfo &diskInfo)
     }
 
     qDebug() << m_subscribers;
-    foreach (Subscriber *sub, m_subscribers) {
-        QString url = device->getMountPointUrl().toString();
-        QStringList devList = DDiskManager::resolveDeviceNode(device->getId(), {});
-        if (devList.isEmpty()) continue;
-        QScopedPointer<DBlockDevice> blkdev(DDiskManager::createBlockDevice(devList.first()));
-        QScopedPointer<DDiskDevice> drive(DDiskManager::createDiskDevice(blkdev->drive()));
-        if (drive->optical()) {
-            url = DUrl::fromBurnFile(device->getId() + "/" + BURN_SEG_ONDISC + "/").toString();
-        }
-        qDebug() << url;
-        sub->doSubscriberAction(url);
+    if (!m_subscribers.isEmpty()) {
+        notifySubscribers(device);
     }
 
 }
@@ -478,6 +615,7 @@ void UDiskListener::removeMountDiskInfo(const QDiskInfo &diskInfo)
 {
     UDiskDeviceInfoPointer device;
     qDebug() << diskInfo;
+    m_mountedRootUris.remove(diskInfo.id());
     qDebug() << m_map.contains(diskInfo.id());
     qDebug() << m_map;
     if (m_map.value(diskInfo.id())) {
@@ -33,6 +33,7 @@
 #include <QDBusObjectPath>
 #include <QList>
 #include <QMap>
+#include <QHash>
 #include <QDBusArgument>
 #include <QXmlStreamReader>
 #include <QDBusPendingReply>
@@ -43,12 +44,14 @@
 #define EventTypeVolumeRemoved 2
 #define EventTypeMountAdded 3
 #define EventTypeMountRemoved 4
+#define EventTypeVolumeChanged 5
 
 class UDiskDeviceInfo;
 class Subscriber;
 
 class DDiskManager;
 class DBlockDevice;
+class QTimer;
 
 class UDiskListener : public DAbstractFileController
 {
@@ -102,6 +105,8 @@ signals:
     void volumeChanged(UDiskDeviceInfoPointer device);
     void mountAdded(UDiskDeviceInfoPointer device);
     void mountRemoved(UDiskDeviceInfoPointer device);
+    // emitted once after a batch of device events changed any mount
+    void mountsChanged();
 
 public slots:
     void update();
@@ -119,8 +124,12 @@ public slots:
 private slots:
     void fileSystemDeviceIdLabelChanged(const QString &path);
     void insertFileSystemDevice(const QString dbusPath);
+    void processDiskInfoEvents();
 
 private:
+    void queueDiskInfoEvent(int type, const QDiskInfo &diskInfo);
+    void notifySubscribers(UDiskDeviceInfoPointer device);
+
     DDiskManager* m_diskMgr = nullptr;
     QMap<QString, DBlockDevice*> m_fsDevMap;
 
@@ -130,6 +139,11 @@ private:
 
     QList<Subscriber *> m_subscribers;
 
+    QList<QPair<int, QDiskInfo>> m_diskInfoEvents;
+    QTimer *m_diskInfoEventTimer = nullptr;
+    // the mounted root uri of the devices handled by addMountDiskInfo
+    QHash<QString, QString> m_mountedRootUris;
+
 };
 
 #endif // UDISKLISTENER_H
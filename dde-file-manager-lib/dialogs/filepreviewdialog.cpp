@@ -31,6 +31,12 @@
 #include <QCursor>
 #include <QDesktopWidget>
 #include <QHBoxLayout>
+#include <QtConcurrent>
+
+// the entries around the current one are prefetched in both directions
+#define PREFETCH_COUNT 2
+// the previews of the other types kept for reusing
+#define MAX_POOLED_PREVIEWS 3
 
 DFM_BEGIN_NAMESPACE
 
@@ -260,6 +266,8 @@ FilePreviewDialog::~FilePreviewDialog()
         m_preview->deleteLater();
         QGuiApplication::changeOverrideCursor(QCursor(Qt::ArrowCursor));
     }
+
+    clearPreviewPool();
 }
 
 void FilePreviewDialog::updatePreviewList(const DUrlList &previewUrllist)
@@ -302,6 +310,8 @@ void FilePreviewDialog::closeEvent(QCloseEvent *event)
         m_preview = nullptr;
     }
 
+    clearPreviewPool();
+
     return DAbstractDialog::closeEvent(event);
 }
 
@@ -402,6 +412,16 @@ static QString generalKey(const QString &key)
     return key;
 }
 
+static QStringList previewKeys(const QMimeType &mime_type)
+{
+    QStringList key_list(mime_type.name());
+
+    key_list.append(mime_type.aliases());
+    key_list.append(mime_type.allAncestors());
+
+    return key_list;
+}
+
 void FilePreviewDialog::switchToPage(int index)
 {
     if (m_preview) {
@@ -424,12 +444,9 @@ void FilePreviewDialog::switchToPage(int index)
     }
 
     DFMFilePreview *preview = nullptr;
-    const QMimeType &mime_type = info->mimeType();
-
-    QStringList key_list(mime_type.name());
-
-    key_list.append(mime_type.aliases());
-    key_list.append(mime_type.allAncestors());
+    // the mime types of the entries around are detected by the prefetch stage
+    const QStringList &key_list = m_previewKeys.contains(m_fileList.at(index))
+            ? m_previewKeys.value(m_fileList.at(index)) : previewKeys(info->mimeType());
 
     for (const QString &key : key_list) {
         const QString &general_key = generalKey(key);
@@ -443,10 +460,26 @@ void FilePreviewDialog::switchToPage(int index)
                 m_statusBar->openButton()->setFocus();
                 playCurrentPreviewFile();
                 moveToCenter();
+                prefetchNeighbors();
                 return;
             }
         }
 
+        preview = takePooledPreview(key);
+
+        if (!preview && general_key != key) {
+            preview = takePooledPreview(general_key);
+        }
+
+        if (preview) {
+            if (preview->setFileUrl(m_fileList.at(index)))
+                break;
+            else if (info->canRedirectionFileUrl() && preview->setFileUrl(info->redirectedFileUrl()))
+                break;
+
+            m_previewPool.append(preview);
+        }
+
         preview = DFMFilePreviewFactory::create(key);
 
         if (!preview && general_key != key) {
@@ -470,32 +503,29 @@ void FilePreviewDialog::switchToPage(int index)
             m_statusBar->openButton()->setFocus();
             return;
         } else {
+            preview = takePooledPreview(QString());
+
+            if (!preview) {
+                preview = new UnknowFilePreview(this);
+                preview->initialize(this, m_statusBar);
+            }
 
-            preview = new UnknowFilePreview(this);
-            preview->initialize(this, m_statusBar);
             preview->setFileUrl(m_fileList.at(index));
         }
     }
 
-    if (m_preview)
-        disconnect(m_preview, &DFMFilePreview::titleChanged, this, &FilePreviewDialog::updateTitle);
-
     connect(preview, &DFMFilePreview::titleChanged, this, &FilePreviewDialog::updateTitle);
 
     if (m_preview)
-        m_preview->deleteLater();
-
-    if (m_preview) {
-        static_cast<QVBoxLayout*>(layout())->removeWidget(m_preview->contentWidget());
-    }
+        poolPreview(m_preview);
 
     static_cast<QVBoxLayout*>(layout())->insertWidget(0, preview->contentWidget());
+    preview->contentWidget()->show();
 
-    if (m_preview)
-        static_cast<QHBoxLayout*>(m_statusBar->layout())->removeWidget(m_preview->statusBarWidget());
-
-    if (QWidget * w = preview->statusBarWidget())
+    if (QWidget * w = preview->statusBarWidget()) {
         static_cast<QHBoxLayout*>(m_statusBar->layout())->insertWidget(3, w, 0, preview->statusBarWidgetAlignment());
+        w->show();
+    }
 
     m_separator->setVisible(preview->showStatusBarSeparator());
     m_preview = preview;
@@ -506,6 +536,7 @@ void FilePreviewDialog::switchToPage(int index)
         m_statusBar->openButton()->setFocus();
         playCurrentPreviewFile();
         moveToCenter();
+        prefetchNeighbors();
     });
 }
 
@@ -530,6 +561,8 @@ void FilePreviewDialog::done(int r)
         m_preview->deleteLater();
         m_preview = nullptr;
     }
+
+    clearPreviewPool();
 }
 
 void FilePreviewDialog::playCurrentPreviewFile()
@@ -553,6 +586,134 @@ void FilePreviewDialog::nextPage()
     switchToPage(m_currentPageIndex + 1);
 }
 
+void FilePreviewDialog::prefetchNeighbors()
+{
+    DUrlList urls;
+
+    // the next files first, the user is more likely to go forward
+    for (int i = 1; i <= PREFETCH_COUNT; ++i) {
+        if (m_currentPageIndex + i < m_fileList.count())
+            urls << m_fileList.at(m_currentPageIndex + i);
+
+        if (m_currentPageIndex - i >= 0)
+            urls << m_fileList.at(m_currentPageIndex - i);
+    }
+
+    DUrlList unknown_urls;
+
+    for (const DUrl &url : urls) {
+        if (!m_previewKeys.contains(url))
+            unknown_urls << url;
+    }
+
+    const quint64 generation = ++m_prefetchGeneration;
+
+    // the mime types are detected by reading the files, it's done on a worker thread
+    QFutureWatcher<QHash<DUrl, QStringList>> *fw = new QFutureWatcher<QHash<DUrl, QStringList>>(this);
+
+    connect(fw, &QFutureWatcher<QHash<DUrl, QStringList>>::finished, this, [this, fw, urls, generation] {
+        fw->deleteLater();
+
+        // the user has moved to another entry
+        if (generation != m_prefetchGeneration)
+            return;
+
+        // only the entries around the current one are needed
+        if (m_previewKeys.count() > PREFETCH_COUNT * 16)
+            m_previewKeys.clear();
+
+        const QHash<DUrl, QStringList> &keys = fw->result();
+
+        for (auto it = keys.constBegin(); it != keys.constEnd(); ++it)
+            m_previewKeys.insert(it.key(), it.value());
+
+        for (const DUrl &url : urls) {
+            DFMFilePreview *preview = suitedPreview(m_previewKeys.value(url));
+
+            // the prefetch slot is optional, see DFMFilePreview
+            if (preview && preview->metaObject()->indexOfSlot("prefetch(DUrl)") >= 0)
+                QMetaObject::invokeMethod(preview, "prefetch", Qt::DirectConnection, Q_ARG(DUrl, url));
+        }
+    });
+
+    fw->setFuture(QtConcurrent::run([unknown_urls] {
+        QHash<DUrl, QStringList> keys;
+
+        for (const DUrl &url : unknown_urls) {
+            const DAbstractFileInfoPointer &info = DFileService::instance()->createFileInfo(nullptr, url);
+
+            if (info)
+                keys[url] = previewKeys(info->mimeType());
+        }
+
+        return keys;
+    }));
+}
+
+DFMFilePreview *FilePreviewDialog::suitedPreview(const QStringList &keys) const
+{
+    QList<DFMFilePreview*> previews = m_previewPool;
+
+    if (m_preview)
+        previews.prepend(m_preview);
+
+    for (const QString &key : keys) {
+        const QString &general_key = generalKey(key);
+
+        for (DFMFilePreview *preview : previews) {
+            if (DFMFilePreviewFactory::isSuitedWithKey(preview, key)
+                    || DFMFilePreviewFactory::isSuitedWithKey(preview, general_key))
+                return preview;
+        }
+    }
+
+    return nullptr;
+}
+
+DFMFilePreview *FilePreviewDialog::takePooledPreview(const QString &key)
+{
+    for (int i = 0; i < m_previewPool.count(); ++i) {
+        DFMFilePreview *preview = m_previewPool.at(i);
+
+        // the empty key is for the files no plugin can preview
+        if (key.isEmpty() ? qobject_cast<UnknowFilePreview*>(preview) != nullptr
+                          : DFMFilePreviewFactory::isSuitedWithKey(preview, key))
+            return m_previewPool.takeAt(i);
+    }
+
+    return nullptr;
+}
+
+void FilePreviewDialog::poolPreview(DFMFilePreview *preview)
+{
+    disconnect(preview, &DFMFilePreview::titleChanged, this, &FilePreviewDialog::updateTitle);
+
+    preview->stop();
+
+    if (QWidget *w = preview->contentWidget()) {
+        static_cast<QVBoxLayout*>(layout())->removeWidget(w);
+        w->hide();
+    }
+
+    if (QWidget *w = preview->statusBarWidget()) {
+        static_cast<QHBoxLayout*>(m_statusBar->layout())->removeWidget(w);
+        w->hide();
+    }
+
+    m_previewPool.prepend(preview);
+
+    while (m_previewPool.count() > MAX_POOLED_PREVIEWS)
+        m_previewPool.takeLast()->deleteLater();
+}
+
+void FilePreviewDialog::clearPreviewPool()
+{
+    for (DFMFilePreview *preview : m_previewPool)
+        preview->deleteLater();
+
+    m_previewPool.clear();
+}
+
 void FilePreviewDialog::updateTitle()
 {
     QFont font = m_statusBar->title()->font();
@@ -89,6 +89,11 @@ private:
     void switchToPage(int index);
     void previousPage();
     void nextPage();
+    void prefetchNeighbors();
+    DFMFilePreview *suitedPreview(const QStringList &keys) const;
+    DFMFilePreview *takePooledPreview(const QString &key);
+    void poolPreview(DFMFilePreview *preview);
+    void clearPreviewPool();
 
     void updateTitle();
 
@@ -101,6 +106,11 @@ private:
 
     int m_currentPageIndex = -1;
     DFMFilePreview *m_preview = nullptr;
+    // the previews of the other types, the most recently used first
+    QList<DFMFilePreview*> m_previewPool;
+    // the preview factory keys of the entries around the current one
+    QHash<DUrl, QStringList> m_previewKeys;
+    quint64 m_prefetchGeneration = 0;
 
 };
 
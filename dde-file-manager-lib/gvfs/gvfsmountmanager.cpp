@@ -50,10 +50,16 @@
 #include <QLoggingCategory>
 #include <QTimer>
 #include <QJsonArray>
-#include <QProcess>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include <views/windowmanager.h>
 
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/sysmacros.h>
+
 /*afc has no unix_device, so use uuid as unix_device*/
 
 QMap<QString, QDrive> GvfsMountManager::Drives = {}; // key is unix-device
@@ -66,7 +72,7 @@ QStringList GvfsMountManager::Volumes_Drive_Keys = {}; // key is unix-device
 QStringList GvfsMountManager::Volumes_No_Drive_Keys = {}; // key is unix-device or uuid
 
 QStringList GvfsMountManager::NoVolumes_Mounts_Keys = {}; // key is mount point root uri
-QStringList GvfsMountManager::Lsblk_Keys = {}; // key is got by lsblk
+QStringList GvfsMountManager::Lsblk_Keys = {}; // key is got from /proc/self/mountinfo
 
 MountSecretDiskAskPasswordDialog* GvfsMountManager::mountSecretDiskAskPasswordDialog = nullptr;
 
@@ -81,6 +87,134 @@ Q_LOGGING_CATEGORY(mountManager, "gvfs.mountMgr")
 Q_LOGGING_CATEGORY(mountManager, "gvfs.mountMgr", QtInfoMsg)
 #endif
 
+// the octal escapes of /proc/self/mountinfo, such as "\\040" for a space
+static QByteArray unescapeMountInfoField(const QByteArray &field)
+{
+    QByteArray result;
+
+    result.reserve(field.size());
+
+    for (int i = 0; i < field.size(); ++i) {
+        if (field.at(i) == '\\' && i + 3 < field.size()) {
+            bool ok = false;
+            const char c = char(field.mid(i + 1, 3).toInt(&ok, 8));
+
+            if (ok) {
+                result.append(c);
+                i += 3;
+                continue;
+            }
+        }
+
+        result.append(field.at(i));
+    }
+
+    return result;
+}
+
+static QByteArray readSysfsValue(const QString &path)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return file.readAll().trimmed();
+}
+
+// lists the mounted block devices like `lsblk -OJlb` did, but reads
+// /proc/self/mountinfo and sysfs directly instead of running a process
+static QList<QDiskInfo> listMountedBlockDevices()
+{
+    QList<QDiskInfo> diskInfos;
+    QFile mountInfo("/proc/self/mountinfo");
+
+    if (!mountInfo.open(QIODevice::ReadOnly)) {
+        qCWarning(mountManager()) << "Failed to open" << mountInfo.fileName() << mountInfo.errorString();
+        return diskInfos;
+    }
+
+    QMap<QString, QString> uuids;
+    const QFileInfoList &uuidLinks = QDir("/dev/disk/by-uuid").entryInfoList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+
+    for (const QFileInfo &link : uuidLinks) {
+        uuids.insert(link.canonicalFilePath(), link.fileName());
+    }
+
+    QSet<QString> devices;
+
+    for (const QByteArray &line : mountInfo.readAll().split('\n')) {
+        // id parent major:minor root mount_point options [optional fields] - fs_type source super_options
+        const QList<QByteArray> &fields = line.split(' ');
+        const int separator = fields.indexOf("-");
+
+        if (separator < 6 || fields.size() < separator + 3) {
+            continue;
+        }
+
+        const QString &device = QString::fromLocal8Bit(unescapeMountInfoField(fields.at(separator + 2)));
+        const QString &mountPoint = QString::fromLocal8Bit(unescapeMountInfoField(fields.at(4)));
+
+        // the first mount of a device is used, the same as lsblk
+        if (!device.startsWith("/dev/") || devices.contains(device)) {
+            continue;
+        }
+
+        devices.insert(device);
+
+        if (mountPoint == "/") {
+            continue;
+        }
+
+        struct stat st;
+
+        if (stat(device.toLocal8Bit().constData(), &st) != 0 || !S_ISBLK(st.st_mode)) {
+            continue;
+        }
+
+        const QString &sysfsPath = QString("/sys/dev/block/%1:%2").arg(major(st.st_rdev)).arg(minor(st.st_rdev));
+        QDiskInfo diskInfo;
+
+        diskInfo.setMounted_root_uri(QString("file://%1").arg(mountPoint));
+        diskInfo.setName(QFileInfo(device).fileName());
+        diskInfo.setUnix_device(device);
+        diskInfo.setId(diskInfo.unix_device());
+        diskInfo.setId_filesystem(QString::fromLocal8Bit(unescapeMountInfoField(fields.at(separator + 1))));
+        diskInfo.setUuid(uuids.value(QFileInfo(device).canonicalFilePath()));
+
+        // a partition is removable if its disk is
+        const QString &sysfsDevicePath = QFileInfo(sysfsPath).canonicalFilePath();
+        const QString &removablePath = QFile::exists(sysfsDevicePath + "/partition")
+                ? QFileInfo(sysfsDevicePath).path() + "/removable" : sysfsDevicePath + "/removable";
+
+        diskInfo.setIs_removable(readSysfsValue(removablePath) == "1");
+
+        struct statvfs vfs;
+
+        if (statvfs(mountPoint.toLocal8Bit().constData(), &vfs) == 0) {
+            diskInfo.setFree(quint64(vfs.f_bavail) * vfs.f_frsize);
+            diskInfo.setTotal(quint64(vfs.f_blocks) * vfs.f_frsize);
+        } else {
+            // the size in sysfs is in 512 bytes sectors
+            diskInfo.setTotal(readSysfsValue(sysfsPath + "/size").toULongLong() * 512);
+        }
+
+        diskInfo.setCan_unmount(true);
+        diskInfo.setCan_mount(false);
+        diskInfo.setCan_eject(false);
+        if (diskInfo.is_removable()){
+            diskInfo.setType("removable");
+        }else{
+            diskInfo.setType("native");
+        }
+
+        diskInfos.append(diskInfo);
+    }
+
+    return diskInfos;
+}
+
 GvfsMountManager::GvfsMountManager(QObject *parent) : QObject(parent)
 {
     if (getDialogManager(false)) {
@@ -435,13 +569,8 @@ void GvfsMountManager::monitor_mount_added_root(GVolumeMonitor *volume_monitor,
     QMount qMount = gMountToqMount(mount);
     qCDebug(mountManager()) << qMount;
 
-    foreach (QString key, DiskInfos.keys()) {
-        QDiskInfo info = DiskInfos.value(key);
-        if (info.mounted_root_uri() == qMount.mounted_root_uri()){
-            emit gvfsMountManager->volume_added(info);
-            return;
-        }
-    }
+    // volume_added is emitted for the new devices found by the scan
+    gvfsMountManager->listMountsByMountInfo();
 }
 
 void GvfsMountManager::monitor_mount_removed_root(GVolumeMonitor *volume_monitor, GMount *mount)
@@ -450,13 +579,9 @@ void GvfsMountManager::monitor_mount_removed_root(GVolumeMonitor *volume_monitor
     qCDebug(mountManager()) << "==============================monitor_mount_removed_root==============================";
     QMount qMount = gMountToqMount(mount);
     qCDebug(mountManager()) << qMount;
-    foreach (QString key, DiskInfos.keys()) {
-        QDiskInfo info = DiskInfos.value(key);
-        if (info.mounted_root_uri() == qMount.mounted_root_uri()){
-            emit gvfsMountManager->volume_removed(info);
-            return;
-        }
-    }
+
+    // volume_removed is emitted for the devices gone from the scan
+    gvfsMountManager->listMountsByMountInfo();
 }
 
 
@@ -950,7 +1075,8 @@ bool GvfsMountManager::isDeviceCrypto_LUKS(const QDiskInfo &diskInfo)
 void GvfsMountManager::startMonitor()
 {
     if (DFMGlobal::isRootUser()){
-        listMountsBylsblk();
+        // loadDiskInfoFinished is emitted when the first scan is finished
+        listMountsByMountInfo();
     }else{
         listDrives();
         listVolumes();
@@ -967,7 +1093,9 @@ void GvfsMountManager::startMonitor()
     }
 #endif
     initConnect();
-    emit loadDiskInfoFinished();
+    if (!DFMGlobal::isRootUser()) {
+        emit loadDiskInfoFinished();
+    }
 }
 
 void GvfsMountManager::listDrives()
@@ -1109,86 +1237,64 @@ void GvfsMountManager::getMounts(GList *mounts)
     }
 }
 
-void GvfsMountManager::listMountsBylsblk()
-{
-    QString output;
-    QString err;
-    QProcess p;
-    p.setProgram("lsblk");
-    p.setArguments({"-OJlb"});
-    p.start();
-    p.waitForFinished(-1);
-    output = p.readAllStandardOutput();
-    err = p.readAllStandardError();
-    bool status = p.exitStatus() == QProcess::NormalExit && p.exitCode() == 0;
-    if(status){
-        QJsonParseError error;
-        QJsonDocument doc=QJsonDocument::fromJson(output.toLocal8Bit(),&error);
-        if (error.error == QJsonParseError::NoError){
-            QJsonObject devObj = doc.object();
-            foreach (QString key, devObj.keys()) {
-                if (key == "blockdevices"){
-                    QJsonArray objArray = devObj.value(key).toArray();
-                    for(int i=0; i< objArray.count(); i++){
-                        QJsonObject obj = objArray.at(i).toObject();
-                        QDiskInfo diskInfo;
-
-                        if (obj.contains("mountpoint")){
-                            QString mountPoint = obj.value("mountpoint").toString();
-                            if (mountPoint.isEmpty() || mountPoint=="/"){
-                                continue;
-                            }else{
-                                diskInfo.setMounted_root_uri(QString("file://%1").arg(obj.value("mountpoint").toString()));
-                            }
-                        }
-
-                        if (obj.contains("name")){
-                            diskInfo.setName(obj.value("name").toString());
-                        }
-                        if (obj.contains("path")){
-                            diskInfo.setUnix_device(obj.value("path").toString());
-                            diskInfo.setId(diskInfo.unix_device());
-                        }
-                        if (obj.contains("fstype")){
-                            diskInfo.setId_filesystem(obj.value("fstype").toString());
-                        }
-                        if (obj.contains("label")){
-                            //diskInfo.setName(obj.value("label").toString());
-                        }
-                        if (obj.contains("uuid")){
-                            diskInfo.setUuid(obj.value("uuid").toString());
-                        }
-                        if(obj.contains("rm")){
-                            QVariant data(obj.value("rm").toVariant());
-                            diskInfo.setIs_removable(data.toBool());
-                        }
-                        if (obj.contains("fsavail") && obj.value("fsavail").type() != QJsonValue::Type::Null) {
-                            diskInfo.setFree(obj.value("fsavail").toVariant().toULongLong());
-                        }
-                        if (obj.contains("fssize") && obj.value("fssize").type() != QJsonValue::Type::Null) {
-                            diskInfo.setTotal(obj.value("fssize").toVariant().toULongLong());
-                        } else if (obj.contains("size") && obj.value("size").type() != QJsonValue::Type::Null) {
-                            diskInfo.setTotal(obj.value("size").toVariant().toULongLong());
-                        }
-
-                        diskInfo.setCan_unmount(true);
-                        diskInfo.setCan_mount(false);
-                        diskInfo.setCan_eject(false);
-                        if (diskInfo.is_removable()){
-                            diskInfo.setType("removable");
-                        }else{
-                            diskInfo.setType("native");
-                        }
-                        Lsblk_Keys.append(diskInfo.unix_device());
-                        DiskInfos.insert(diskInfo.id(), diskInfo);
-                    }
-                }
-            }
-        }else{
-            qCDebug(mountManager()) << error.errorString();
+void GvfsMountManager::listMountsByMountInfo()
+{
+    // the changes happened during a scan are picked up by one more scan
+    if (m_mountInfoScanning) {
+        m_mountInfoRescan = true;
+        return;
+    }
+
+    m_mountInfoScanning = true;
+
+    QFutureWatcher<QList<QDiskInfo>> *watcher = new QFutureWatcher<QList<QDiskInfo>>(this);
+
+    connect(watcher, &QFutureWatcher<QList<QDiskInfo>>::finished, this, [this, watcher] {
+        m_mountInfoScanning = false;
+        updateMountInfoDiskInfos(watcher->result());
+        watcher->deleteLater();
+
+        if (m_mountInfoRescan) {
+            m_mountInfoRescan = false;
+            listMountsByMountInfo();
         }
-    }else{
-        qCDebug(mountManager()) << status << output << err;
+    });
+
+    watcher->setFuture(QtConcurrent::run(listMountedBlockDevices));
+}
+
+void GvfsMountManager::updateMountInfoDiskInfos(const QList<QDiskInfo> &diskInfos)
+{
+    const bool firstScan = !m_mountInfoLoaded;
+    QStringList keys;
+
+    m_mountInfoLoaded = true;
+
+    for (const QDiskInfo &diskInfo : diskInfos) {
+        keys.append(diskInfo.id());
+    }
+
+    for (const QString &key : Lsblk_Keys) {
+        if (!keys.contains(key)) {
+            const QDiskInfo diskInfo = DiskInfos.take(key);
+            emit volume_removed(diskInfo);
+        }
+    }
+
+    for (const QDiskInfo &diskInfo : diskInfos) {
+        const bool added = !Lsblk_Keys.contains(diskInfo.id());
+
+        DiskInfos.insert(diskInfo.id(), diskInfo);
+
+        if (added && !firstScan) {
+            emit volume_added(diskInfo);
+        }
+    }
+
+    Lsblk_Keys = keys;
+
+    if (firstScan) {
+        emit loadDiskInfoFinished();
     }
 }
 
@@ -166,10 +166,15 @@ public slots:
     void updateDiskInfos();
     void getMounts(GList *mounts);
 
-    void listMountsBylsblk();
+    void listMountsByMountInfo();
 
 private:
+    void updateMountInfoDiskInfos(const QList<QDiskInfo> &diskInfos);
+
     GVolumeMonitor* m_gVolumeMonitor = nullptr;
+    bool m_mountInfoScanning = false;
+    bool m_mountInfoRescan = false;
+    bool m_mountInfoLoaded = false;
     static QPointer<QEventLoop> eventLoop;
     static bool errorCodeNeedSilent(int errorCode);
 };
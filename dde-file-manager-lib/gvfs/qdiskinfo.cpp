@@ -332,6 +332,36 @@ QDiskInfo QDiskInfo::getDiskInfo(const DAbstractFileInfo &fileInfo)
 }
 
 
+bool QDiskInfo::operator==(const QDiskInfo &other) const
+{
+    return m_id == other.m_id
+            && m_name == other.m_name
+            && m_type == other.m_type
+            && m_drive_unix_device == other.m_drive_unix_device
+            && m_unix_device == other.m_unix_device
+            && m_uuid == other.m_uuid
+            && m_activation_root_uri == other.m_activation_root_uri
+            && m_mounted_root_uri == other.m_mounted_root_uri
+            && m_iconName == other.m_iconName
+            && m_id_filesystem == other.m_id_filesystem
+            && m_default_location == other.m_default_location
+            && m_is_removable == other.m_is_removable
+            && m_can_mount == other.m_can_mount
+            && m_can_unmount == other.m_can_unmount
+            && m_can_eject == other.m_can_eject
+            && m_read_only == other.m_read_only
+            && m_has_volume == other.m_has_volume
+            && m_used == other.m_used
+            && m_total == other.m_total
+            && m_free == other.m_free
+            && m_isNativeCustom == other.m_isNativeCustom;
+}
+
+bool QDiskInfo::operator!=(const QDiskInfo &other) const
+{
+    return !operator==(other);
+}
+
 QDebug operator<<(QDebug dbg, const QDiskInfo &info)
 {
     dbg.nospace() << "QDiskInfo(";
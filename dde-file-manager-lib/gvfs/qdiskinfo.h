@@ -108,6 +108,9 @@ public:
 
     static QDiskInfo getDiskInfo(const DAbstractFileInfo &fileInfo);
 
+    bool operator==(const QDiskInfo &other) const;
+    bool operator!=(const QDiskInfo &other) const;
+
 private:
     QString m_id;
     QString m_name;
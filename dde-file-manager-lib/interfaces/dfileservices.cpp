@@ -66,20 +66,40 @@
 #include <QMimeData>
 #include <QTimer>
 #include <QStandardPaths>
+#include <QReadWriteLock>
 
 DWIDGET_USE_NAMESPACE
 
 class DFileServicePrivate
 {
 public:
+    static void clearResolvedHandlers();
+
     static QMultiHash<const HandlerType, DAbstractFileController *> controllerHash;
     static QHash<const DAbstractFileController *, HandlerType> handlerHash;
     static QMultiHash<const HandlerType, HandlerCreatorType> controllerCreatorHash;
+
+    // the events are processed in the worker threads too
+    static QReadWriteLock resolvedHandlerLock;
+    static QHash<HandlerType, QList<DAbstractFileController *>> resolvedHandlerHash;
+    // bumped by every clear, a list resolved before a clear is not cached
+    static quint64 resolvedHandlerGeneration;
 };
 
 QMultiHash<const HandlerType, DAbstractFileController *> DFileServicePrivate::controllerHash;
 QHash<const DAbstractFileController *, HandlerType> DFileServicePrivate::handlerHash;
 QMultiHash<const HandlerType, HandlerCreatorType> DFileServicePrivate::controllerCreatorHash;
+QReadWriteLock DFileServicePrivate::resolvedHandlerLock;
+QHash<HandlerType, QList<DAbstractFileController *>> DFileServicePrivate::resolvedHandlerHash;
+quint64 DFileServicePrivate::resolvedHandlerGeneration = 0;
+
+void DFileServicePrivate::clearResolvedHandlers()
+{
+    QWriteLocker locker(&resolvedHandlerLock);
+
+    resolvedHandlerHash.clear();
+    ++resolvedHandlerGeneration;
+}
 
 DFileService::DFileService(QObject *parent)
     : QObject(parent)
@@ -107,17 +127,19 @@ template<typename T>
 QVariant eventProcess(DFileService *service, const QSharedPointer<DFMEvent> &event, T function)
 {
     QSet<DAbstractFileController *> controller_set;
-    QSet<QString> scheme_set;
+    QSet<HandlerType> type_set;
 
     for (const DUrl &url : event->handleUrlList()) {
-        QList<DAbstractFileController *> list = service->getHandlerTypeByUrl(url);
-        if (!scheme_set.contains(url.scheme())) {
-            list << service->getHandlerTypeByUrl(url, true);
-        } else {
-            scheme_set << url.scheme();
+        const HandlerType type(url.scheme(), url.host());
+
+        // the handlers of the type were all tried with the previous url
+        if (type_set.contains(type)) {
+            continue;
         }
 
-        for (DAbstractFileController *controller : list) {
+        type_set << type;
+
+        for (DAbstractFileController *controller : service->getResolvedHandlersByUrl(url)) {
             if (controller_set.contains(controller)) {
                 continue;
             }
@@ -457,6 +479,7 @@ bool DFileService::setFileUrlHandler(const QString &scheme, const QString &host,
 
     DFileServicePrivate::handlerHash[controller] = type;
     DFileServicePrivate::controllerHash.insertMulti(type, controller);
+    DFileServicePrivate::clearResolvedHandlers();
 
     return true;
 }
@@ -468,6 +491,7 @@ void DFileService::unsetFileUrlHandler(DAbstractFileController *controller)
     }
 
     DFileServicePrivate::controllerHash.remove(DFileServicePrivate::handlerHash.value(controller), controller);
+    DFileServicePrivate::clearResolvedHandlers();
 }
 
 void DFileService::clearFileUrlHandler(const QString &scheme, const QString &host)
@@ -476,6 +500,7 @@ void DFileService::clearFileUrlHandler(const QString &scheme, const QString &hos
 
     DFileServicePrivate::controllerHash.remove(handler);
     DFileServicePrivate::controllerCreatorHash.remove(handler);
+    DFileServicePrivate::clearResolvedHandlers();
 }
 
 bool DFileService::openFile(const QObject *sender, const DUrl &url) const
@@ -824,6 +849,41 @@ QList<DAbstractFileController*> DFileService::getHandlerTypeByUrl(const DUrl &fi
     return DFileServicePrivate::controllerHash.values(handlerType);
 }
 
+QList<DAbstractFileController *> DFileService::getResolvedHandlersByUrl(const DUrl &fileUrl)
+{
+    const HandlerType type(fileUrl.scheme(), fileUrl.host());
+    quint64 generation;
+
+    {
+        QReadLocker locker(&DFileServicePrivate::resolvedHandlerLock);
+        auto it = DFileServicePrivate::resolvedHandlerHash.constFind(type);
+
+        if (it != DFileServicePrivate::resolvedHandlerHash.constEnd()) {
+            return it.value();
+        }
+
+        generation = DFileServicePrivate::resolvedHandlerGeneration;
+    }
+
+    // the creators of the type are run by the first lookup
+    QList<DAbstractFileController *> list = getHandlerTypeByUrl(fileUrl);
+
+    for (DAbstractFileController *controller : getHandlerTypeByUrl(fileUrl, true)) {
+        if (!list.contains(controller)) {
+            list << controller;
+        }
+    }
+
+    QWriteLocker locker(&DFileServicePrivate::resolvedHandlerLock);
+
+    // the handlers were changed while this list was resolved, it may be stale
+    if (generation == DFileServicePrivate::resolvedHandlerGeneration) {
+        DFileServicePrivate::resolvedHandlerHash[type] = list;
+    }
+
+    return list;
+}
+
 QString DFileService::getSymlinkFileName(const DUrl &fileUrl, const QDir &targetDir)
 {
     const DAbstractFileInfoPointer &pInfo = instance()->createFileInfo(Q_NULLPTR, fileUrl);
@@ -878,6 +938,7 @@ QString DFileService::getSymlinkFileName(const DUrl &fileUrl, const QDir &target
 void DFileService::insertToCreatorHash(const HandlerType &type, const HandlerCreatorType &creator)
 {
     DFileServicePrivate::controllerCreatorHash.insertMulti(type, creator);
+    DFileServicePrivate::clearResolvedHandlers();
 }
 
 void DFileService::laterRequestSelectFiles(const DFMUrlListBaseEvent &event) const
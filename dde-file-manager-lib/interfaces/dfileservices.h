@@ -105,6 +105,9 @@ public:
     static QList<DAbstractFileController *> getHandlerTypeByUrl(const DUrl &fileUrl,
             bool ignoreHost = false,
             bool ignoreScheme = false);
+    // the handlers of the scheme and host of the url, then of the scheme,
+    // the result is cached until the handlers are changed
+    static QList<DAbstractFileController *> getResolvedHandlersByUrl(const DUrl &fileUrl);
 
     bool openFile(const QObject *sender, const DUrl &url) const;
     bool openFileByApp(const QObject *sender, const QString &appName, const DUrl &url) const;
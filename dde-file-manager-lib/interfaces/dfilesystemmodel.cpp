@@ -40,6 +40,7 @@
 #include "interfaces/durl.h"
 #include "interfaces/dfileviewhelper.h"
 #include "shutil/fileutils.h"
+#include "shutil/dfmexecutor.h"
 #include "deviceinfo/udisklistener.h"
 
 #include <memory>
@@ -274,6 +275,25 @@ public:
         return visibleChildren;
     }
 
+    // prefix sums of the file sizes and of the directories of the visible children
+    void getChildrenStatistics(QVector<qint64> &sizePrefix, QVector<int> &directoryPrefix)
+    {
+        QReadLocker rl(rwLock);
+
+        sizePrefix.resize(visibleChildren.count() + 1);
+        directoryPrefix.resize(visibleChildren.count() + 1);
+        sizePrefix[0] = 0;
+        directoryPrefix[0] = 0;
+
+        for (int i = 0; i < visibleChildren.count(); ++i) {
+            const DAbstractFileInfoPointer &info = visibleChildren.at(i)->fileInfo;
+            const bool is_dir = info->isDir();
+
+            sizePrefix[i + 1] = sizePrefix[i] + (is_dir ? 0 : info->size());
+            directoryPrefix[i + 1] = directoryPrefix[i] + (is_dir ? 1 : 0);
+        }
+    }
+
     DUrlList getChildrenUrlList()
     {
         DUrlList list;
@@ -828,6 +848,8 @@ public:
     QPointer<JobController> jobController;
     QEventLoop *eventLoop = Q_NULLPTR;
     QFuture<void> updateChildrenFuture;
+    // the queued tasks of the model are dropped when it's destroyed
+    DFMExecutor::CancelToken cancelToken = DFMExecutor::createCancelToken();
     QAtomicInteger<bool> needQuitUpdateChildren;
     DAbstractFileWatcher *watcher = Q_NULLPTR;
     std::shared_ptr<FileFilter> advanceSearchFilter;
@@ -848,9 +870,46 @@ public:
     // 每列包含多个role时，存储此列活跃的role
     QMap<int, int> columnActiveRole;
 
+    // used by rowsStatistics, rebuilt on demand after the rows are changed
+    mutable QVector<qint64> sizePrefix;
+    mutable QVector<int> directoryPrefix;
+    mutable bool statisticsDirty = true;
+
+    void updateRowStatistics(const QModelIndex &index, const DAbstractFileInfoPointer &fileInfo);
+
     Q_DECLARE_PUBLIC(DFileSystemModel)
 };
 
+// a file of the root was changed in place, its size is updated in the prefix sums
+// without walking the other file infos
+void DFileSystemModelPrivate::updateRowStatistics(const QModelIndex &index, const DAbstractFileInfoPointer &fileInfo)
+{
+    const int row = index.row();
+    const FileSystemNodePointer &node = q_func()->getNodeByIndex(index);
+
+    if (statisticsDirty || !node || node->parent != rootNode.data() || row + 1 >= sizePrefix.count()) {
+        return;
+    }
+
+    const bool is_dir = fileInfo->isDir();
+
+    // a file became a directory or the other way around, rare enough for a rebuild
+    if ((directoryPrefix.at(row + 1) - directoryPrefix.at(row) == 1) != is_dir) {
+        statisticsDirty = true;
+        return;
+    }
+
+    const qint64 delta = (is_dir ? 0 : fileInfo->size()) - (sizePrefix.at(row + 1) - sizePrefix.at(row));
+
+    if (delta == 0) {
+        return;
+    }
+
+    for (int i = row + 1; i < sizePrefix.count(); ++i) {
+        sizePrefix[i] += delta;
+    }
+}
+
 DFileSystemModelPrivate::~DFileSystemModelPrivate()
 {
     if (_q_processFileEvent_runing) {
@@ -958,6 +1017,7 @@ void DFileSystemModelPrivate::_q_onFileUpdated(const DUrl &fileUrl)
 
     if (const DAbstractFileInfoPointer &fileInfo = q->fileInfo(index)) {
         fileInfo->refresh();
+        updateRowStatistics(index, fileInfo);
     }
 
     q->parent()->parent()->update(index);
@@ -984,6 +1044,8 @@ void DFileSystemModelPrivate::_q_onFileUpdated(const DUrl &fileUrl, const int &i
         if (isExternalSource) {
             fileInfo->refresh();
         }
+
+        updateRowStatistics(index, fileInfo);
     }
 
     q->parent()->parent()->update(index);
@@ -1065,12 +1127,32 @@ DFileSystemModel::DFileSystemModel(DFileViewHelper *parent)
 {
     qRegisterMetaType<State>(QT_STRINGIFY(State));
     qRegisterMetaType<DAbstractFileInfoPointer>(QT_STRINGIFY(DAbstractFileInfoPointer));
+
+    auto invalidateStatistics = [this] {
+        d_func()->statisticsDirty = true;
+    };
+
+    connect(this, &DFileSystemModel::rowsInserted, this, invalidateStatistics);
+    connect(this, &DFileSystemModel::rowsRemoved, this, invalidateStatistics);
+    connect(this, &DFileSystemModel::rowsMoved, this, invalidateStatistics);
+    // the sorting and the refreshing of all the files change all the roles, the
+    // icons and the other properties don't change the statistics
+    connect(this, &DFileSystemModel::dataChanged, this, [this] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+        if (roles.isEmpty() || roles.contains(FileSizeRole) || roles.contains(FileSizeInKiloByteRole)
+                || roles.contains(FileMimeTypeRole)) {
+            d_func()->statisticsDirty = true;
+        }
+    });
+    connect(this, &DFileSystemModel::layoutChanged, this, invalidateStatistics);
+    connect(this, &DFileSystemModel::modelReset, this, invalidateStatistics);
 }
 
 DFileSystemModel::~DFileSystemModel()
 {
     Q_D(DFileSystemModel);
 
+    DFMExecutor::cancel(d->cancelToken);
+
     if (d->jobController) {
         d->jobController->stopAndDeleteLater();
     }
@@ -1625,6 +1707,8 @@ bool DFileSystemModel::dropMimeData(const QMimeData *data, Qt::DropAction action
     case Qt::CopyAction:
         if (urlList.count() > 0) {
             // blumia: 如果不在新线程跑的话，用户就只能在复制完毕之后才能进行新的拖拽操作。
+            // only waits for the paste, which is a task of DFMExecutor::FileOperation, so it
+            // must not take a thread of that executor
             QtConcurrent::run([=](){
                 fileService->pasteFile(this, DFMGlobal::CopyAction, toUrl, urlList);
             });
@@ -2027,13 +2111,10 @@ bool DFileSystemModel::sort(bool emitDataChange)
         return false;
     }
 
-    if (QThreadPool::globalInstance()->activeThreadCount() >= MAX_THREAD_COUNT) {
-        qDebug() << "Beyond the maximum number of threads!";
-        return false;
-    }
-
     if (QThread::currentThread() == qApp->thread()) {
-        QtConcurrent::run(QThreadPool::globalInstance(), this, &DFileSystemModel::sort);
+        if (!DFMExecutor::instance(DFMExecutor::Cpu)->tryRun([this] { sort(); }, d->cancelToken)) {
+            qDebug() << "Beyond the maximum number of threads!";
+        }
 
         return false;
     }
@@ -2068,6 +2149,35 @@ const DAbstractFileInfoPointer DFileSystemModel::fileInfo(const QModelIndex &ind
     return node ? node->fileInfo : DAbstractFileInfoPointer();
 }
 
+void DFileSystemModel::rowsStatistics(int first, int last, int *fileCount, int *directoryCount, qint64 *fileSize) const
+{
+    Q_D(const DFileSystemModel);
+
+    *fileCount = 0;
+    *directoryCount = 0;
+    *fileSize = 0;
+
+    if (!d->rootNode) {
+        return;
+    }
+
+    if (d->statisticsDirty) {
+        d->rootNode->getChildrenStatistics(d->sizePrefix, d->directoryPrefix);
+        d->statisticsDirty = false;
+    }
+
+    first = qMax(first, 0);
+    last = qMin(last, d->sizePrefix.count() - 2);
+
+    if (first > last) {
+        return;
+    }
+
+    *directoryCount = d->directoryPrefix.at(last + 1) - d->directoryPrefix.at(first);
+    *fileCount = last - first + 1 - *directoryCount;
+    *fileSize = d->sizePrefix.at(last + 1) - d->sizePrefix.at(first);
+}
+
 const DAbstractFileInfoPointer DFileSystemModel::fileInfo(const DUrl &fileUrl) const
 {
     Q_D(const DFileSystemModel);
@@ -2273,11 +2383,9 @@ void DFileSystemModel::updateChildrenOnNewThread(QList<DAbstractFileInfoPointer>
         d->jobController->pause();
     }
 
-    if (QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount()) {
-        QThreadPool::globalInstance()->setMaxThreadCount(QThreadPool::globalInstance()->maxThreadCount() + 10);
-    }
-
-    d->updateChildrenFuture = QtConcurrent::run(QThreadPool::globalInstance(), this, &DFileSystemModel::updateChildren, list);
+    d->updateChildrenFuture = DFMExecutor::forUrl(rootUrl())->run([this, list] {
+        updateChildren(list);
+    }, d->cancelToken);
 }
 
 void DFileSystemModel::refresh(const DUrl &fileUrl)
@@ -2601,7 +2709,7 @@ void DFileSystemModel::addFile(const DAbstractFileInfoPointer &fileInfo)
                 DAbstractFileInfo::CompareFunction compareFun = fileInfo->compareFunByColumn(d->sortRole);
 
                 if (compareFun) {
-                    result = QtConcurrent::run(QThreadPool::globalInstance(), [&] {
+                    result = DFMExecutor::instance(DFMExecutor::Cpu)->run([&] {
                         forever
                         {
                             if (!me || row >= parentNode->childrenCount()) {
@@ -2623,7 +2731,7 @@ void DFileSystemModel::addFile(const DAbstractFileInfoPointer &fileInfo)
             } else if (fileInfo->isFile()) {
                 row = -1;
             } else {
-                result = QtConcurrent::run(QThreadPool::globalInstance(), [&] {
+                result = DFMExecutor::instance(DFMExecutor::Cpu)->run([&] {
                     forever
                     {
                         if (!me || row >= parentNode->childrenCount()) {
@@ -181,6 +181,10 @@ public:
     const DAbstractFileInfoPointer parentFileInfo(const QModelIndex &index) const;
     const DAbstractFileInfoPointer parentFileInfo(const DUrl &fileUrl) const;
 
+    // counts the files and directories in the rows [first, last] of the root and sums the file
+    // sizes from the cached file infos. O(1) once the prefix sums are built after a row change.
+    void rowsStatistics(int first, int last, int *fileCount, int *directoryCount, qint64 *fileSize) const;
+
     State state() const;
 
     void setReadOnly(bool readOnly);
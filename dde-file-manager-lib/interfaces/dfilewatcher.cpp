@@ -14,6 +14,7 @@
 #include "dfilesystemwatcher.h"
 
 #include "private/dfilesystemwatcher_p.h"
+#include "shutil/dfmhiddenfilecache.h"
 
 #include <QDir>
 #include <QDebug>
@@ -275,6 +276,13 @@ QString DFileWatcherPrivate::formatPath(const QString &path)
     return p.isEmpty() ? path : p;
 }
 
+// the cached .hidden file of the directory is outdated
+static void checkHiddenFileList(const QString &path, const QString &name)
+{
+    if (name == QStringLiteral(".hidden"))
+        DFMHiddenFileCache::instance()->invalidate(path);
+}
+
 DFileWatcher::DFileWatcher(const QString &filePath, QObject *parent)
     : DAbstractFileWatcher(*new DFileWatcherPrivate(this), DUrl::fromLocalFile(filePath), parent)
 {
@@ -283,6 +291,8 @@ DFileWatcher::DFileWatcher(const QString &filePath, QObject *parent)
 
 void DFileWatcher::onFileDeleted(const QString &path, const QString &name)
 {
+    checkHiddenFileList(path, name);
+
     if (name.isEmpty())
         d_func()->_q_handleFileDeleted(path, QString());
     else
@@ -299,6 +309,9 @@ void DFileWatcher::onFileAttributeChanged(const QString &path, const QString &na
 
 void DFileWatcher::onFileMoved(const QString &from, const QString &fname, const QString &to, const QString &tname)
 {
+    checkHiddenFileList(from, fname);
+    checkHiddenFileList(to, tname);
+
     QString fromPath, fpPath;
     QString toPath, tpPath;
 
@@ -321,11 +334,15 @@ void DFileWatcher::onFileMoved(const QString &from, const QString &fname, const
 
 void DFileWatcher::onFileCreated(const QString &path, const QString &name)
 {
+    checkHiddenFileList(path, name);
+
     d_func()->_q_handleFileCreated(joinFilePath(path, name), path);
 }
 
 void DFileWatcher::onFileModified(const QString &path, const QString &name)
 {
+    checkHiddenFileList(path, name);
+
     if (name.isEmpty())
         d_func()->_q_handleFileModified(path, QString());
     else
@@ -334,6 +351,8 @@ void DFileWatcher::onFileModified(const QString &path, const QString &name)
 
 void DFileWatcher::onFileClosed(const QString &path, const QString &name)
 {
+    checkHiddenFileList(path, name);
+
     if (name.isEmpty())
         d_func()->_q_handleFileClose(path, QString());
     else
@@ -69,7 +69,8 @@ public:
         GA_DisableNonRemovableDeviceUnmount, // 禁用本地磁盘卸载功能
         GA_HiddenSystemPartition, // 隐藏系统分区
         GA_ShowRecentFileEntry, // 在侧边栏显示“最近文件”入口
-        GA_ShowCsdCrumbBarClickableArea // 在面包屑栏预留可供点击以进入地址栏编辑状态的区域
+        GA_ShowCsdCrumbBarClickableArea, // 在面包屑栏预留可供点击以进入地址栏编辑状态的区域
+        GA_BuiltinSearchIndex // 未被 deepin-anything 索引的本地磁盘使用内置的文件名索引进行搜索
     };
 
     Q_ENUM(GenericAttribute)
@@ -293,7 +293,8 @@ Q_DECLARE_METATYPE(DFMUrlListBaseEvent)
 template<class T, typename... Args>
 QSharedPointer<T> dMakeEventPointer(Args &&... args)
 {
-    return QSharedPointer<T>(new T(std::forward<Args>(args)...));
+    // the event and the reference count in one allocation
+    return QSharedPointer<T>::create(std::forward<Args>(args)...);
 }
 
 class DFMOpenFileEvent : public DFMUrlBaseEvent
@@ -8,13 +8,19 @@
  **/
 #include "dfmeventdispatcher.h"
 #include "dfmabstracteventhandler.h"
+#include "shutil/dfmexecutor.h"
 
 #include <QList>
 #include <QtConcurrentRun>
 #include <QFutureWatcher>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QDebug>
 
+// the bucket n counts the events taking less than 2^n us, the last one counts the rest
+#define LATENCY_BUCKET_COUNT 24
+
 DFM_BEGIN_NAMESPACE
 
 class DFMEventDispatcherPrivate
@@ -114,7 +120,70 @@ namespace DFMEventDispatcherData
     static QList<DFMAbstractEventHandler*> eventHandler;
     static QList<DFMAbstractEventHandler*> eventFilter;
 
-    Q_GLOBAL_STATIC(QThreadPool, threadPool)
+    struct EventStatistics
+    {
+        quint64 count = 0;
+        quint64 totalTime = 0;
+        quint64 maxTime = 0;
+        quint64 buckets[LATENCY_BUCKET_COUNT] = {};
+    };
+
+    // the custom events share the last one
+    static const int statisticsCount = DFMEvent::GetTagsThroughFiles + 2;
+    static QMutex statisticsMutex;
+    static EventStatistics statistics[statisticsCount];
+
+    static void recordLatency(DFMEvent::Type type, quint64 time)
+    {
+        int bucket = 0;
+
+        while (bucket < LATENCY_BUCKET_COUNT - 1 && (quint64(1) << bucket) <= time)
+            ++bucket;
+
+        QMutexLocker locker(&statisticsMutex);
+        EventStatistics &s = statistics[qBound(0, int(type), statisticsCount - 1)];
+
+        ++s.count;
+        s.totalTime += time;
+        s.maxTime = qMax(s.maxTime, time);
+        ++s.buckets[bucket];
+    }
+
+    // the upper bound of the bucket holding the percentile
+    static quint64 percentile(const EventStatistics &s, int percent)
+    {
+        const quint64 rank = (s.count * percent + 99) / 100;
+        quint64 count = 0;
+
+        for (int i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            count += s.buckets[i];
+
+            if (count >= rank)
+                return i == LATENCY_BUCKET_COUNT - 1 ? s.maxTime : quint64(1) << i;
+        }
+
+        return s.maxTime;
+    }
+
+    // the nested events are counted in the time of their parent too
+    class LatencyRecorder
+    {
+    public:
+        explicit LatencyRecorder(DFMEvent::Type type)
+            : m_type(type)
+        {
+            m_timer.start();
+        }
+
+        ~LatencyRecorder()
+        {
+            recordLatency(m_type, m_timer.nsecsElapsed() / 1000);
+        }
+
+    private:
+        DFMEvent::Type m_type;
+        QElapsedTimer m_timer;
+    };
 }
 
 class DFMEventDispatcher_ : public DFMEventDispatcher {};
@@ -134,6 +203,8 @@ QVariant DFMEventDispatcher::processEvent(const QSharedPointer<DFMEvent> &event,
 {
     Q_D(DFMEventDispatcher);
 
+    DFMEventDispatcherData::LatencyRecorder recorder(event->type());
+
     d->setState(Busy);
 
     QVariant result;
@@ -159,18 +230,16 @@ QVariant DFMEventDispatcher::processEvent(const QSharedPointer<DFMEvent> &event,
 
 DFMEventFuture DFMEventDispatcher::processEventAsync(const QSharedPointer<DFMEvent> &event, DFMAbstractEventHandler *target)
 {
-    QThreadPool *pool = DFMEventDispatcherData::threadPool;
-
-    if (pool->maxThreadCount() <= pool->activeThreadCount()) {
-        pool->setMaxThreadCount(pool->maxThreadCount() + 2);
-    }
-
-    return DFMEventFuture(QtConcurrent::run(pool, this, static_cast<QVariant(DFMEventDispatcher::*)(const QSharedPointer<DFMEvent>&, DFMAbstractEventHandler *)>(&DFMEventDispatcher::processEvent), event, target));
+    return DFMEventFuture(DFMExecutor::instance(DFMExecutor::FileOperation)->run([this, event, target] {
+        return processEvent(event, target);
+    }));
 }
 
 QVariant DFMEventDispatcher::processEventWithEventLoop(const QSharedPointer<DFMEvent> &event, DFMAbstractEventHandler *target)
 {
     const DFMEventFuture &future = processEventAsync(event, target);
+    // a file operation may wait for another one, e.g. pasteFile in a task
+    DFMExecutor::WaitScope wait_scope;
 
     future.waitForFinishedWithEventLoop();
 
@@ -196,6 +265,40 @@ DFMEventDispatcher::State DFMEventDispatcher::state() const
     return d->state;
 }
 
+QStringList DFMEventDispatcher::eventStatistics() const
+{
+    using namespace DFMEventDispatcherData;
+
+    QStringList list;
+    QMutexLocker locker(&statisticsMutex);
+
+    for (int i = 0; i < statisticsCount; ++i) {
+        const EventStatistics &s = statistics[i];
+
+        if (s.count == 0)
+            continue;
+
+        const QString &name = i == statisticsCount - 1 ? QStringLiteral("Custom") : DFMEvent::typeToName(static_cast<DFMEvent::Type>(i));
+
+        list << QString("%1 count=%2 avg=%3us p50<=%4us p90<=%5us p99<=%6us max=%7us")
+             .arg(name).arg(s.count).arg(s.totalTime / s.count)
+             .arg(percentile(s, 50)).arg(percentile(s, 90)).arg(percentile(s, 99))
+             .arg(s.maxTime);
+    }
+
+    return list;
+}
+
+void DFMEventDispatcher::resetEventStatistics()
+{
+    using namespace DFMEventDispatcherData;
+
+    QMutexLocker locker(&statisticsMutex);
+
+    for (EventStatistics &s : statistics)
+        s = EventStatistics();
+}
+
 DFMEventDispatcher::DFMEventDispatcher()
     : d_ptr(new DFMEventDispatcherPrivate(this))
 {
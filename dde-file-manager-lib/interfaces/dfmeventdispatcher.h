@@ -14,6 +14,7 @@
 
 #include <QFuture>
 #include <QEventLoop>
+#include <QStringList>
 
 class DFMEvent;
 DFM_BEGIN_NAMESPACE
@@ -88,6 +89,10 @@ public:
 
     State state() const;
 
+    // a line per event type: the count and the latency of processEvent
+    QStringList eventStatistics() const;
+    void resetEventStatistics();
+
 signals:
     void stateChanged(State state);
 
@@ -40,6 +40,10 @@ public:
 
     virtual void copyFile() const;
 
+    // A preview may start loading a file which may be previewed next, without showing
+    // it, in a "void prefetch(const DUrl &url)" slot. It's not virtual so the plugins
+    // built against the older headers keep working.
+
 signals:
     void titleChanged();
 };
@@ -40,22 +40,44 @@ static inline QString parseDecodedComponent(const QString &data)
     return QString(data).replace(QLatin1Char('%'), QStringLiteral("%25"));
 }
 
-QSet<QString> schemeList = QSet<QString>() << QString(TRASH_SCHEME)
-                           << QString(RECENT_SCHEME)
-                           << QString(BOOKMARK_SCHEME)
-                           << QString(FILE_SCHEME)
-                           << QString(COMPUTER_SCHEME)
-                           << QString(SEARCH_SCHEME)
-                           << QString(NETWORK_SCHEME)
-                           << QString(SMB_SCHEME)
-                           << QString(AFC_SCHEME)
-                           << QString(MTP_SCHEME)
-                           << QString(USERSHARE_SCHEME)
-                           << QString(AVFS_SCHEME)
-                           << QString(FTP_SCHEME)
-                           << QString(SFTP_SCHEME)
-                           << QString(DAV_SCHEME)
-                           << QString{ TAG_SCHEME };
+QSet<QString> schemeList = QSet<QString>() << QStringLiteral(TRASH_SCHEME)
+                           << QStringLiteral(RECENT_SCHEME)
+                           << QStringLiteral(BOOKMARK_SCHEME)
+                           << QStringLiteral(FILE_SCHEME)
+                           << QStringLiteral(COMPUTER_SCHEME)
+                           << QStringLiteral(SEARCH_SCHEME)
+                           << QStringLiteral(NETWORK_SCHEME)
+                           << QStringLiteral(SMB_SCHEME)
+                           << QStringLiteral(AFC_SCHEME)
+                           << QStringLiteral(MTP_SCHEME)
+                           << QStringLiteral(USERSHARE_SCHEME)
+                           << QStringLiteral(AVFS_SCHEME)
+                           << QStringLiteral(FTP_SCHEME)
+                           << QStringLiteral(SFTP_SCHEME)
+                           << QStringLiteral(DAV_SCHEME)
+                           << QStringLiteral(TAG_SCHEME);
+
+// schemes which are not in schemeList but are still compared frequently
+static const QSet<QString> internalSchemeList = QSet<QString>() << QStringLiteral(DEVICE_SCHEME)
+                                                << QStringLiteral(MOUNT_SCHEME)
+                                                << QStringLiteral(BURN_SCHEME)
+                                                << QStringLiteral(GPHOTO2_SCHEME)
+                                                << QStringLiteral(DFMMD_SCHEME)
+                                                << QStringLiteral(DFMROOT_SCHEME)
+                                                << QStringLiteral(DFMVAULT_SCHEME);
+
+// decoded components of search/tag/bookmark urls, parsed once and shared by all copies
+struct DUrl::ComponentCache
+{
+    QAtomicInt ref {1};
+
+    QString searchKeyword;
+    DUrl searchTargetUrl;
+    DUrl searchedFileUrl;
+    QString tagName;
+    DUrl bookmarkTargetUrl;
+    QString bookmarkName;
+};
 
 DUrl::DUrl()
     : QUrl()
@@ -69,19 +91,31 @@ DUrl::DUrl(const QUrl &copy)
     updateVirtualPath();
 }
 
+DUrl::~DUrl()
+{
+    clearCache();
+}
 
 DUrl::DUrl(const DUrl &other)
     : QUrl{other},
-      m_virtualPath{other.m_virtualPath}
-
+      m_virtualPath{other.m_virtualPath},
+      m_hash{other.m_hash.load()}
 {
     //###copy constructor
+    ComponentCache *cache = other.m_componentCache.loadAcquire();
+
+    if (cache) {
+        cache->ref.ref();
+        m_componentCache.storeRelease(cache);
+    }
 }
 
 
 DUrl::DUrl(DUrl &&other)
     : QUrl{ std::move(other) },
-      m_virtualPath{ std::move(other.m_virtualPath) }
+      m_virtualPath{ std::move(other.m_virtualPath) },
+      m_hash{ other.m_hash.fetchAndStoreRelaxed(0) },
+      m_componentCache{ other.m_componentCache.fetchAndStoreOrdered(nullptr) }
 {
     //###move constructor
 }
@@ -90,9 +124,22 @@ DUrl::DUrl(DUrl &&other)
 //###copy operator=
 DUrl &DUrl::operator=(const DUrl &other)
 {
+    if (this == &other)
+        return *this;
+
     QUrl::operator=(other);
     m_virtualPath = other.m_virtualPath;
 
+    ComponentCache *cache = other.m_componentCache.loadAcquire();
+
+    if (cache) {
+        cache->ref.ref();
+    }
+
+    clearCache();
+    m_hash.store(other.m_hash.load());
+    m_componentCache.storeRelease(cache);
+
     return *this;
 }
 
@@ -100,9 +147,16 @@ DUrl &DUrl::operator=(const DUrl &other)
 //###move operator=
 DUrl &DUrl::operator=(DUrl &&other)
 {
+    if (this == &other)
+        return *this;
+
     QUrl::operator=(std::move(other));
     m_virtualPath = std::move(other.m_virtualPath);
 
+    clearCache();
+    m_hash.store(other.m_hash.fetchAndStoreRelaxed(0));
+    m_componentCache.storeRelease(other.m_componentCache.fetchAndStoreOrdered(nullptr));
+
     return *this;
 }
 
@@ -134,6 +188,7 @@ DUrl::DUrl(const QString &url, QUrl::ParsingMode mode)
 
 void DUrl::setPath(const QString &path, QUrl::ParsingMode mode, bool makeAbsolute)
 {
+    clearCache();
     QUrl::setPath(path, mode);
 
     if (makeAbsolute) {
@@ -145,7 +200,9 @@ void DUrl::setPath(const QString &path, QUrl::ParsingMode mode, bool makeAbsolut
 
 void DUrl::setScheme(const QString &scheme, bool makeAbsolute)
 {
-    QUrl::setScheme(scheme);
+    clearCache();
+    // share the string data of the well-known schemes instead of keeping a copy per url
+    QUrl::setScheme(internedScheme(scheme));
 
     if (makeAbsolute) {
         this->makeAbsolutePath();
@@ -156,6 +213,7 @@ void DUrl::setScheme(const QString &scheme, bool makeAbsolute)
 
 void DUrl::setUrl(const QString &url, QUrl::ParsingMode parsingMode, bool makeAbsolute)
 {
+    clearCache();
     QUrl::setUrl(url, parsingMode);
 
     if (makeAbsolute) {
@@ -165,76 +223,130 @@ void DUrl::setUrl(const QString &url, QUrl::ParsingMode parsingMode, bool makeAb
     updateVirtualPath();
 }
 
+void DUrl::setQuery(const QString &query, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setQuery(query, mode);
+}
+
+void DUrl::setQuery(const QUrlQuery &query)
+{
+    clearCache();
+    QUrl::setQuery(query);
+}
+
+void DUrl::setFragment(const QString &fragment, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setFragment(fragment, mode);
+}
+
+void DUrl::setHost(const QString &host, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setHost(host, mode);
+}
+
+void DUrl::setPort(int port)
+{
+    clearCache();
+    QUrl::setPort(port);
+}
+
+void DUrl::setUserName(const QString &userName, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setUserName(userName, mode);
+}
+
+void DUrl::setPassword(const QString &password, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setPassword(password, mode);
+}
+
+void DUrl::setUserInfo(const QString &userInfo, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setUserInfo(userInfo, mode);
+}
+
+void DUrl::setAuthority(const QString &authority, QUrl::ParsingMode mode)
+{
+    clearCache();
+    QUrl::setAuthority(authority, mode);
+}
+
 bool DUrl::isTrashFile() const
 {
-    return scheme() == TRASH_SCHEME;
+    return scheme() == QStringLiteral(TRASH_SCHEME);
 }
 
 bool DUrl::isRecentFile() const
 {
-    return scheme() == RECENT_SCHEME;
+    return scheme() == QStringLiteral(RECENT_SCHEME);
 }
 
 bool DUrl::isBookMarkFile() const
 {
-    return scheme() == BOOKMARK_SCHEME;
+    return scheme() == QStringLiteral(BOOKMARK_SCHEME);
 }
 
 bool DUrl::isSearchFile() const
 {
-    return scheme() == SEARCH_SCHEME;
+    return scheme() == QStringLiteral(SEARCH_SCHEME);
 }
 
 bool DUrl::isComputerFile() const
 {
-    return scheme() == COMPUTER_SCHEME;
+    return scheme() == QStringLiteral(COMPUTER_SCHEME);
 }
 
 bool DUrl::isNetWorkFile() const
 {
-    return scheme() == NETWORK_SCHEME;
+    return scheme() == QStringLiteral(NETWORK_SCHEME);
 }
 
 bool DUrl::isSMBFile() const
 {
-    return scheme() == SMB_SCHEME;
+    return scheme() == QStringLiteral(SMB_SCHEME);
 }
 
 bool DUrl::isAFCFile() const
 {
-    return scheme() == AFC_SCHEME;
+    return scheme() == QStringLiteral(AFC_SCHEME);
 }
 
 bool DUrl::isMTPFile() const
 {
-    return scheme() == MTP_SCHEME;
+    return scheme() == QStringLiteral(MTP_SCHEME);
 }
 
 bool DUrl::isUserShareFile() const
 {
-    return scheme() == USERSHARE_SCHEME;
+    return scheme() == QStringLiteral(USERSHARE_SCHEME);
 }
 
 bool DUrl::isAVFSFile() const
 {
-    return scheme() == AVFS_SCHEME;
+    return scheme() == QStringLiteral(AVFS_SCHEME);
 }
 
 bool DUrl::isFTPFile() const
 {
-    return scheme() == FTP_SCHEME;
+    return scheme() == QStringLiteral(FTP_SCHEME);
 }
 
 bool DUrl::isSFTPFile() const
 {
-    return scheme() == SFTP_SCHEME;
+    return scheme() == QStringLiteral(SFTP_SCHEME);
 }
 
 
 ///###: Judge whether current the scheme of current url is equal to TAG_SCHEME.
 bool DUrl::isTaggedFile() const
 {
-    return (this->scheme() == QString{TAG_SCHEME});
+    return (this->scheme() == QStringLiteral(TAG_SCHEME));
 }
 
 QString DUrl::toString(QUrl::FormattingOptions options) const
@@ -260,9 +372,7 @@ QString DUrl::searchKeyword() const
         return QString();
     }
 
-    QUrlQuery query(this->query());
-
-    return query.queryItemValue("keyword", FullyDecoded);
+    return componentCache()->searchKeyword;
 }
 
 DUrl DUrl::searchTargetUrl() const
@@ -271,9 +381,7 @@ DUrl DUrl::searchTargetUrl() const
         return DUrl();
     }
 
-    QUrlQuery query(this->query());
-
-    return DUrl(query.queryItemValue("url", FullyDecoded));
+    return componentCache()->searchTargetUrl;
 }
 
 DUrl DUrl::searchedFileUrl() const
@@ -282,7 +390,7 @@ DUrl DUrl::searchedFileUrl() const
         return DUrl();
     }
 
-    return DUrl(fragment(FullyDecoded));
+    return componentCache()->searchedFileUrl;
 }
 
 ///###: tag:///tagA#real file path(fregment).
@@ -301,9 +409,7 @@ QString DUrl::taggedLocalFilePath() const noexcept
 QString DUrl::tagName() const noexcept
 {
     if(this->isTaggedFile()){
-        QUrlQuery qq(query());
-        return qq.hasQueryItem("tagname") ? qq.queryItemValue("tagname") : QUrl::fileName();
-        //return this->fileName();
+        return componentCache()->tagName;
     }
 
     return QString{};
@@ -324,18 +430,18 @@ QString DUrl::deviceId() const
 
 DUrl DUrl::bookmarkTargetUrl() const
 {
-    if (scheme() != BOOKMARK_SCHEME)
+    if (scheme() != QStringLiteral(BOOKMARK_SCHEME))
         return DUrl();
 
-    return DUrl(path());
+    return componentCache()->bookmarkTargetUrl;
 }
 
 QString DUrl::bookmarkName() const
 {
-    if (scheme() != BOOKMARK_SCHEME)
+    if (scheme() != QStringLiteral(BOOKMARK_SCHEME))
         return QString();
 
-    return fragment(FullyDecoded);
+    return componentCache()->bookmarkName;
 }
 
 QString DUrl::burnDestDevice() const
@@ -412,6 +518,7 @@ void DUrl::setSearchedFileUrl(const DUrl &url)
 void DUrl::setTaggedFileUrl(const QString& localFilePath) noexcept
 {
     if (this->isTaggedFile()) {
+        clearCache();
         this->QUrl::setFragment(localFilePath, QUrl::DecodedMode);
     }
 }
@@ -695,7 +802,23 @@ DUrl DUrl::parentUrl(const DUrl &url)
         return DUrl();
     }
 
-    _url.setScheme(url.scheme());
+    _url.setScheme(url.scheme(), false);
+
+    // fast path for the common absolute path, cut at the last separator
+    // instead of splitting and joining every segment of a deep path
+    if (path.startsWith('/')) {
+        int end = path.size();
+
+        if (path.endsWith('/')) {
+            --end;
+        }
+
+        int index = path.lastIndexOf('/', end - 1);
+        _url.setPath(index > 0 ? path.left(index) : QStringLiteral("/"));
+
+        return _url;
+    }
+
     QStringList paths = path.split("/");
     paths.removeAt(0);
     if (!paths.isEmpty() && paths.last().isEmpty()) {
@@ -721,12 +844,37 @@ bool DUrl::hasScheme(const QString &scheme)
     return schemeList.contains(scheme);
 }
 
+QString DUrl::internedScheme(const QString &scheme)
+{
+    auto it = schemeList.constFind(scheme);
+
+    if (it != schemeList.constEnd()) {
+        return *it;
+    }
+
+    it = internalSchemeList.constFind(scheme);
+
+    if (it != internalSchemeList.constEnd()) {
+        return *it;
+    }
+
+    return scheme;
+}
+
 bool DUrl::operator ==(const DUrl &url) const
 {
     if (!hasScheme(url.scheme())) {
         return QUrl::operator ==(url);
     }
 
+    // urls with different hash values can never be equal
+    uint hash1 = m_hash.loadAcquire();
+    uint hash2 = url.m_hash.loadAcquire();
+
+    if (hash1 != 0 && hash2 != 0 && hash1 != hash2) {
+        return false;
+    }
+
     QString path1 = m_virtualPath;
     QString path2 = url.m_virtualPath;
 
@@ -746,6 +894,9 @@ void DUrl::makeAbsolutePath()
         return;
     }
 
+    // the path is set by QUrl directly
+    clearCache();
+
     if (isLocalFile()) {
         const QString &path = toLocalFile();
 
@@ -789,6 +940,53 @@ QString DUrl::toLocalFile() const
     }
 }
 
+void DUrl::clearCache()
+{
+    m_hash.storeRelease(0);
+
+    ComponentCache *cache = m_componentCache.fetchAndStoreOrdered(nullptr);
+
+    if (cache && !cache->ref.deref()) {
+        delete cache;
+    }
+}
+
+const DUrl::ComponentCache *DUrl::componentCache() const
+{
+    ComponentCache *cache = m_componentCache.loadAcquire();
+
+    if (cache) {
+        return cache;
+    }
+
+    cache = new ComponentCache;
+
+    const QString &scheme = this->scheme();
+
+    if (scheme == QStringLiteral(SEARCH_SCHEME)) {
+        QUrlQuery query(this->query());
+
+        cache->searchKeyword = query.queryItemValue("keyword", FullyDecoded);
+        cache->searchTargetUrl = DUrl(query.queryItemValue("url", FullyDecoded));
+        cache->searchedFileUrl = DUrl(fragment(FullyDecoded));
+    } else if (scheme == QStringLiteral(TAG_SCHEME)) {
+        QUrlQuery qq(query());
+
+        cache->tagName = qq.hasQueryItem("tagname") ? qq.queryItemValue("tagname") : QUrl::fileName();
+    } else if (scheme == QStringLiteral(BOOKMARK_SCHEME)) {
+        cache->bookmarkTargetUrl = DUrl(path());
+        cache->bookmarkName = fragment(FullyDecoded);
+    }
+
+    // another thread may have been faster, use its result
+    if (!m_componentCache.testAndSetOrdered(nullptr, cache)) {
+        delete cache;
+        cache = m_componentCache.loadAcquire();
+    }
+
+    return cache;
+}
+
 void DUrl::updateVirtualPath()
 {
     m_virtualPath = toAbsolutePathUrl().path();
@@ -811,14 +1009,27 @@ QDebug operator<<(QDebug deg, const DUrl &url)
 }
 
 uint qHash(const DUrl &url, uint seed) Q_DECL_NOTHROW {
-    return qHash(url.scheme()) ^
-    qHash(url.userName()) ^
-    qHash(url.password()) ^
-    qHash(url.host()) ^
-    qHash(url.port(), seed) ^
-    qHash(url.m_virtualPath) ^
-    qHash(url.query()) ^
-    qHash(url.fragment());
+    uint hash = url.m_hash.loadAcquire();
+
+    if (hash == 0) {
+        hash = qHash(url.scheme()) ^
+               qHash(url.userName()) ^
+               qHash(url.password()) ^
+               qHash(url.host()) ^
+               qHash(url.port()) ^
+               qHash(url.m_virtualPath) ^
+               qHash(url.query()) ^
+               qHash(url.fragment());
+
+        // 0 is reserved for "not computed"
+        if (hash == 0) {
+            hash = 1;
+        }
+
+        url.m_hash.storeRelease(hash);
+    }
+
+    return hash ^ seed;
 }
 
 QDataStream &operator<<(QDataStream &out, const DUrl &url)
@@ -28,6 +28,8 @@
 #include <QUrl>
 #include <QMetaType>
 #include <QRegularExpression>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
 
 
 #define TRASH_SCHEME "trash"
@@ -92,7 +94,7 @@ public:
     DUrl();
     DUrl(const QUrl &copy);
 
-    virtual ~DUrl() = default;
+    virtual ~DUrl();
     DUrl(const DUrl &other);
     DUrl(DUrl &&other);
     DUrl &operator=(const DUrl &other);
@@ -107,6 +109,18 @@ public:
     void setScheme(const QString &scheme, bool makeAbsolutePath = true);
     void setUrl(const QString &url, ParsingMode parsingMode = TolerantMode, bool makeAbsolutePath = true);
 
+    // QUrl setters are not virtual, shadow them so that the cached hash and
+    // the decoded search/tag/bookmark components are dropped on change.
+    void setQuery(const QString &query, ParsingMode mode = TolerantMode);
+    void setQuery(const QUrlQuery &query);
+    void setFragment(const QString &fragment, ParsingMode mode = TolerantMode);
+    void setHost(const QString &host, ParsingMode mode = DecodedMode);
+    void setPort(int port);
+    void setUserName(const QString &userName, ParsingMode mode = DecodedMode);
+    void setPassword(const QString &password, ParsingMode mode = DecodedMode);
+    void setUserInfo(const QString &userInfo, ParsingMode mode = TolerantMode);
+    void setAuthority(const QString &authority, ParsingMode mode = TolerantMode);
+
     bool isTrashFile() const;
     bool isRecentFile() const;
     bool isBookMarkFile() const;
@@ -176,6 +190,7 @@ public:
     static DUrlList childrenList(const DUrl &url);
     static DUrl parentUrl(const DUrl &url);
     static bool hasScheme(const QString &scheme);
+    static QString internedScheme(const QString &scheme);
 
     bool operator ==(const DUrl &url) const;
     inline bool operator !=(const DUrl &url) const
@@ -192,9 +207,17 @@ public:
     friend QDataStream &operator>>(QDataStream &in, DUrl &url);
 
 private:
+    struct ComponentCache;
+
     void updateVirtualPath();
+    void clearCache();
+    const ComponentCache *componentCache() const;
 
     QString m_virtualPath;
+    // 0 means not computed yet, a computed hash is never 0
+    mutable QAtomicInteger<uint> m_hash;
+    // shared between copies, created on first access of a decoded component
+    mutable QAtomicPointer<ComponentCache> m_componentCache;
 
     static QRegularExpression burn_rxp;
 };
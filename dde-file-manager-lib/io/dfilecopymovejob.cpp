@@ -35,9 +35,12 @@
 #include <QProcess>
 
 #include <unistd.h>
-#include <zlib.h>
 #include <fcntl.h>
 
+#ifdef Q_PROCESSOR_X86_64
+#include <nmmintrin.h>
+#endif
+
 DFM_BEGIN_NAMESPACE
 
 #ifdef QT_DEBUG
@@ -46,6 +49,92 @@ Q_LOGGING_CATEGORY(fileJob, "file.job")
 Q_LOGGING_CATEGORY(fileJob, "file.job", QtInfoMsg)
 #endif
 
+// CRC32C (Castagnoli), computed while copying, the sse4.2 crc32 instruction is used if the cpu has it
+namespace {
+struct Crc32cTable
+{
+    Crc32cTable()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (int i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+            }
+        }
+    }
+
+    quint32 table[8][256];
+};
+
+// slicing-by-8
+quint32 crc32cSoftware(quint32 crc, const uchar *data, qint64 size)
+{
+    static const Crc32cTable crc_table;
+    const quint32 (&t)[8][256] = crc_table.table;
+
+    crc = ~crc;
+
+    while (size >= 8) {
+        crc ^= quint32(data[0]) | quint32(data[1]) << 8 | quint32(data[2]) << 16 | quint32(data[3]) << 24;
+        crc = t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff] ^ t[5][(crc >> 16) & 0xff] ^ t[4][crc >> 24]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0) {
+        crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+#ifdef Q_PROCESSOR_X86_64
+__attribute__((target("sse4.2")))
+quint32 crc32cHardware(quint32 crc, const uchar *data, qint64 size)
+{
+    quint64 crc64 = ~crc;
+
+    while (size >= 8) {
+        quint64 word;
+
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0) {
+        crc64 = _mm_crc32_u8(quint32(crc64), *data++);
+    }
+
+    return ~quint32(crc64);
+}
+#endif
+
+quint32 crc32c(quint32 crc, const char *data, qint64 size)
+{
+#ifdef Q_PROCESSOR_X86_64
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+
+    if (has_sse42) {
+        return crc32cHardware(crc, reinterpret_cast<const uchar *>(data), size);
+    }
+#endif
+
+    return crc32cSoftware(crc, reinterpret_cast<const uchar *>(data), size);
+}
+}
+
 #if defined(Q_OS_LINUX) && (defined(__GLIBC__) || QT_HAS_INCLUDE(<sys/syscall.h>))
 #  include <sys/syscall.h>
 
@@ -154,6 +243,7 @@ DFileCopyMoveJobPrivate::DFileCopyMoveJobPrivate(DFileCopyMoveJob *qq)
 DFileCopyMoveJobPrivate::~DFileCopyMoveJobPrivate()
 {
     delete updateSpeedElapsedTimer;
+    free(dataBuffer);
 }
 
 QString DFileCopyMoveJobPrivate::errorToString(DFileCopyMoveJob::Error error)
@@ -880,9 +970,49 @@ bool DFileCopyMoveJobPrivate::mergeDirectory(DFileHandler *handler, const DAbstr
     return removeFile(handler, fromInfo);
 }
 
+char *DFileCopyMoveJobPrivate::getDataBuffer(int size)
+{
+    if (size <= dataBufferSize) {
+        return dataBuffer;
+    }
+
+    free(dataBuffer);
+    dataBuffer = nullptr;
+    dataBufferSize = 0;
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const int buffer_size = (size + page_size - 1) / page_size * page_size;
+    void *buffer = nullptr;
+
+    if (posix_memalign(&buffer, page_size, buffer_size) != 0) {
+        return nullptr;
+    }
+
+    dataBuffer = static_cast<char *>(buffer);
+    dataBufferSize = buffer_size;
+
+    return dataBuffer;
+}
+
+DFileDevice *DFileCopyMoveJobPrivate::createFileDevice(const DUrl &url, const DStorageInfo &storageInfo)
+{
+    // 本地磁盘上的文件不用经过事件分发来创建，与 FileController::createFileDevice 的结果相同
+    if (url.isLocalFile() && storageInfo.isValid() && storageInfo.isLocalDevice()) {
+        DLocalFileDevice *device = new DLocalFileDevice();
+
+        device->setFileUrl(url);
+
+        return device;
+    }
+
+    return DFileService::instance()->createFileDevice(nullptr, url);
+}
+
 bool DFileCopyMoveJobPrivate::doCopyFile(const DAbstractFileInfo *fromInfo, const DAbstractFileInfo *toInfo, int blockSize)
 {
-    QScopedPointer<DFileDevice> fromDevice(DFileService::instance()->createFileDevice(nullptr, fromInfo->fileUrl()));
+    const DStorageInfo &source_storage_info = directoryStack.isEmpty() ? DStorageInfo() : directoryStack.top().sourceStorageInfo;
+    const DStorageInfo &target_storage_info = directoryStack.isEmpty() ? DStorageInfo() : directoryStack.top().targetStorageInfo;
+    QScopedPointer<DFileDevice> fromDevice(createFileDevice(fromInfo->fileUrl(), source_storage_info));
 
     if (!fromDevice) {
         setError(DFileCopyMoveJob::UnknowUrlError, "Failed on create file device");
@@ -890,13 +1020,22 @@ bool DFileCopyMoveJobPrivate::doCopyFile(const DAbstractFileInfo *fromInfo, cons
         return false;
     }
 
-    QScopedPointer<DFileDevice> toDevice(DFileService::instance()->createFileDevice(nullptr, toInfo->fileUrl()));
+    QScopedPointer<DFileDevice> toDevice(createFileDevice(toInfo->fileUrl(), target_storage_info));
 
     if (!toDevice) {
         setError(DFileCopyMoveJob::UnknowUrlError, "Failed on create file device");
 
         return false;
     }
+
+    // 复制和校验使用同一块缓冲区，整个任务中只分配一次
+    char *data = getDataBuffer(blockSize);
+
+    if (!data) {
+        setError(DFileCopyMoveJob::UnknowError, "Failed on allocate the data buffer");
+
+        return false;
+    }
 open_file: {
         DFileCopyMoveJob::Action action = DFileCopyMoveJob::NoAction;
 
@@ -977,8 +1116,15 @@ open_file: {
     currentJobDataSizeInfo.first = fromDevice->size();
     currentJobFileHandle = toDevice->handle();
 
+    // 避免短时间内产生大量脏页，写回时会卡住整个桌面
+    const bool throttle_write_back = targetIsRemovable && toDevice->handle() > 0;
+
+    if (throttle_write_back) {
+        writeBackThrottle.beginFile(toDevice->handle());
+    }
+
 //    int writtenDataSize = 0;
-    uLong source_checksum = adler32(0L, nullptr, 0);
+    quint32 source_checksum = 0;
 
     Q_FOREVER {
         qint64 current_pos = fromDevice->pos();
@@ -987,8 +1133,7 @@ open_file: {
             return false;
         }
 
-        char data[blockSize + 1];
-        qint64 size_read = fromDevice->read(data, blockSize);
+        qint64 size_read = fromDevice->read(data, throttle_write_back ? writeBackThrottle.blockSize(blockSize) : blockSize);
 
         if (Q_UNLIKELY(size_read <= 0)) {
             if (fromDevice->atEnd()) {
@@ -1082,7 +1227,11 @@ open_file: {
 //        writtenDataSize += size_write;
 
         if (Q_LIKELY(!fileHints.testFlag(DFileCopyMoveJob::DontIntegrityChecking))) {
-            source_checksum = adler32(source_checksum, reinterpret_cast<Bytef *>(data), size_read);
+            source_checksum = crc32c(source_checksum, data, size_read);
+        }
+
+        if (throttle_write_back) {
+            writeBackThrottle.fileWritten(toDevice->pos());
         }
 
 //        if (Q_UNLIKELY(writtenDataSize > 20000000)) {
@@ -1091,9 +1240,23 @@ open_file: {
 //        }
     }
 
+    // 可移除设备上的数据更容易损坏，即使没有 VerifyFromMedia 也从磁盘读回校验
+    const bool verify_from_media = !fileHints.testFlag(DFileCopyMoveJob::DontIntegrityChecking)
+            && (fileHints.testFlag(DFileCopyMoveJob::VerifyFromMedia) || targetIsRemovable);
+
+    if (throttle_write_back) {
+        writeBackThrottle.endFile();
+    }
+
     // 关闭文件时可能会需要很长时间，因为内核可能要把内存里的脏数据回写到硬盘
     setState(DFileCopyMoveJob::IOWaitState);
     fromDevice->close();
+
+    // 脏页写回磁盘后才能被丢弃，读回的数据才是磁盘上的数据
+    if (verify_from_media) {
+        toDevice->syncToDisk();
+    }
+
     toDevice->close();
 
     if (state == DFileCopyMoveJob::IOWaitState) {
@@ -1106,6 +1269,14 @@ open_file: {
         return true;
     }
 
+    // 校验值在复制时已计算，从本地磁盘的页缓存读回目标文件并不能校验磁盘上的数据，
+    // 所以只在 VerifyFromMedia 或目标为可移除设备时读回目标文件
+    if (!verify_from_media) {
+        completedFileChecksums.insert(toInfo->fileUrl(), source_checksum);
+
+        return true;
+    }
+
     DFileCopyMoveJob::Action action = DFileCopyMoveJob::NoAction;
 
     do {
@@ -1121,8 +1292,14 @@ open_file: {
         return true;
     }
 
-    char data[blockSize + 1];
-    ulong target_checksum = adler32(0L, nullptr, 0);
+#ifdef Q_OS_LINUX
+    if (toDevice->handle() > 0) {
+        posix_fadvise(toDevice->handle(), 0, 0, POSIX_FADV_DONTNEED);
+        posix_fadvise(toDevice->handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    quint32 target_checksum = 0;
 
     qint64 elapsed_time_checksum = 0;
 
@@ -1151,7 +1328,7 @@ open_file: {
             }
         }
 
-        target_checksum = adler32(target_checksum, reinterpret_cast<Bytef *>(data), size);
+        target_checksum = crc32c(target_checksum, data, size);
 
         if (Q_UNLIKELY(!stateCheck())) {
             return false;
@@ -1161,7 +1338,7 @@ open_file: {
     qCDebug(fileJob(), "Time spent of integrity check of the file: %lld", updateSpeedElapsedTimer->elapsed() - elapsed_time_checksum);
 
     if (source_checksum != target_checksum) {
-        qCWarning(fileJob(), "Failed on file integrity checking, source file: 0x%lx, target file: 0x%lx", source_checksum, target_checksum);
+        qCWarning(fileJob(), "Failed on file integrity checking, source file: 0x%x, target file: 0x%x", source_checksum, target_checksum);
 
         setError(DFileCopyMoveJob::IntegrityCheckingError);
         DFileCopyMoveJob::Action action = handleError(fromInfo, toInfo);
@@ -1177,7 +1354,9 @@ open_file: {
         return false;
     }
 
-    qCDebug(fileJob(), "adler value: 0x%lx", source_checksum);
+    qCDebug(fileJob(), "crc32c value: 0x%x", source_checksum);
+
+    completedFileChecksums.insert(toInfo->fileUrl(), source_checksum);
 
     return true;
 }
@@ -1433,6 +1612,11 @@ void DFileCopyMoveJobPrivate::updateSpeed()
 
     qint64 speed = total_size / time * 1000;
 
+    // 平均速度包含了写入页缓存的时间，用测得的设备写入速度计算剩余时间更准确
+    if (targetIsRemovable && writeBackThrottle.speed() > 0) {
+        speed = writeBackThrottle.speed();
+    }
+
     // 如果进度已经是100%，则不应该再有速度波动
     if (fileStatistics->isFinished() && total_size >= fileStatistics->totalSize()) {
         speed = 0;
@@ -1583,6 +1767,14 @@ QList<QPair<DUrl, DUrl>> DFileCopyMoveJob::completedFiles() const
     return d->completedFileList;
 }
 
+QHash<DUrl, quint32> DFileCopyMoveJob::completedFileChecksums() const
+{
+    Q_D(const DFileCopyMoveJob);
+    Q_ASSERT(d->state != RunningState);
+
+    return d->completedFileChecksums;
+}
+
 QList<QPair<DUrl, DUrl>> DFileCopyMoveJob::completedDirectorys() const
 {
     Q_D(const DFileCopyMoveJob);
@@ -1720,6 +1912,7 @@ void DFileCopyMoveJob::run()
     d->setState(RunningState);
     d->completedDirectoryList.clear();
     d->completedFileList.clear();
+    d->completedFileChecksums.clear();
     d->targetUrlList.clear();
     d->completedDataSize = 0;
     d->completedDataSizeOnBlockDevice = 0;
@@ -1753,6 +1946,7 @@ void DFileCopyMoveJob::run()
         d->targetDeviceStartSectorsWritten = -1;
         d->targetSysDevPath.clear();
         d->targetRootPath.clear();
+        d->writeBackThrottle.reset();
 
         QScopedPointer<DStorageInfo> targetStorageInfo(DFileService::instance()->createStorageInfo(nullptr, d->targetUrl));
 
@@ -1765,45 +1959,44 @@ void DFileCopyMoveJob::run()
             if (targetStorageInfo->isLocalDevice()) {
                 d->canUseWriteBytes = targetStorageInfo->fileSystemType().startsWith("ext");
 
-                if (!d->canUseWriteBytes) {
-                    const QByteArray dev_path = targetStorageInfo->device();
+                // 可移除设备的写入需要限速，所以 ext 文件系统也要查询设备信息
+                const QByteArray dev_path = targetStorageInfo->device();
 
-                    QProcess process;
+                QProcess process;
 
-                    process.start("lsblk", {"-niro", "MAJ:MIN,HOTPLUG,LOG-SEC", dev_path}, QIODevice::ReadOnly);
+                process.start("lsblk", {"-niro", "MAJ:MIN,HOTPLUG,LOG-SEC", dev_path}, QIODevice::ReadOnly);
 
-                    if (process.waitForFinished(3000)) {
-                        if (process.exitCode() == 0) {
-                            const QByteArray &data = process.readAllStandardOutput();
-                            const QByteArrayList &list = data.split(' ');
+                if (process.waitForFinished(3000)) {
+                    if (process.exitCode() == 0) {
+                        const QByteArray &data = process.readAllStandardOutput();
+                        const QByteArrayList &list = data.split(' ');
 
-                            qCDebug(fileJob(), "lsblk result data: \"%s\"", data.constData());
+                        qCDebug(fileJob(), "lsblk result data: \"%s\"", data.constData());
 
-                            if (list.size() == 3) {
-                                d->targetSysDevPath = "/sys/dev/block/" + list.first();
-                                d->targetIsRemovable = list.at(1) == "1";
+                        if (list.size() == 3) {
+                            d->targetSysDevPath = "/sys/dev/block/" + list.first();
+                            d->targetIsRemovable = list.at(1) == "1";
 
-                                bool ok = false;
-                                d->targetLogSecionSize = list.at(2).toInt(&ok);
+                            bool ok = false;
+                            d->targetLogSecionSize = list.at(2).toInt(&ok);
 
-                                if (!ok) {
-                                    d->targetLogSecionSize = 512;
+                            if (!ok) {
+                                d->targetLogSecionSize = 512;
 
-                                    qCWarning(fileJob(), );
-                                }
-
-                                if (d->targetIsRemovable) {
-                                    d->targetDeviceStartSectorsWritten = d->getSectorsWritten();
-                                }
+                                qCWarning(fileJob(), );
+                            }
 
-                                qCDebug(fileJob(), "Block device path: \"%s\", Sys dev path: \"%s\", Is removable: %d, Log-Sec: %d",
-                                        qPrintable(dev_path), qPrintable(d->targetSysDevPath), bool(d->targetIsRemovable), d->targetLogSecionSize);
-                            } else {
-                                qCWarning(fileJob(), "Failed on parse the lsblk result data, data: \"%s\"", data.constData());
+                            if (d->targetIsRemovable) {
+                                d->targetDeviceStartSectorsWritten = d->getSectorsWritten();
                             }
+
+                            qCDebug(fileJob(), "Block device path: \"%s\", Sys dev path: \"%s\", Is removable: %d, Log-Sec: %d",
+                                    qPrintable(dev_path), qPrintable(d->targetSysDevPath), bool(d->targetIsRemovable), d->targetLogSecionSize);
                         } else {
-                            qCWarning(fileJob(), "Failed on exec lsblk command, exit code: %d, error message: \"%s\"", process.exitCode(), process.readAllStandardError().constData());
+                            qCWarning(fileJob(), "Failed on parse the lsblk result data, data: \"%s\"", data.constData());
                         }
+                    } else {
+                        qCWarning(fileJob(), "Failed on exec lsblk command, exit code: %d, error message: \"%s\"", process.exitCode(), process.readAllStandardError().constData());
                     }
                 }
 
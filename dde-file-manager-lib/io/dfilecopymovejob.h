@@ -22,6 +22,7 @@
 #define DFILECOPYMOVEJOB_H
 
 #include <QObject>
+#include <QHash>
 
 #include <dfmglobal.h>
 
@@ -96,7 +97,8 @@ public:
         DontIntegrityChecking = 0x40, // 复制文件时不进行完整性校验
         DontFormatFileName = 0x80, // 不要自动处理文件名中的非法字符
         DontSortInode = 0x100, // 不要对目录中的文件按inode排序
-        ForceDeleteFile = 0x200 // 强制删除文件夹(去除文件夹的只读权限)
+        ForceDeleteFile = 0x200, // 强制删除文件夹(去除文件夹的只读权限)
+        VerifyFromMedia = 0x400 // 完整性校验时先把目标文件写入磁盘并丢弃页缓存，再从磁盘读回校验，目标为可移除设备时总是如此
     };
 
     Q_ENUM(FileHint)
@@ -148,6 +150,8 @@ public:
     qint64 totalDataSize() const;
     int totalFilesCount() const;
     QList<QPair<DUrl, DUrl> > completedFiles() const;
+    // 已完成文件的 CRC32C 校验值，key 为目标文件
+    QHash<DUrl, quint32> completedFileChecksums() const;
     QList<QPair<DUrl, DUrl> > completedDirectorys() const;
 
     static Actions supportActions(Error error);
@@ -0,0 +1,859 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dfilenameindex.h"
+#include "dfilesystemwatcher.h"
+#include "dfmstandardpaths.h"
+#include "dfmapplication.h"
+#include "controllers/filecontroller.h"
+#include "shutil/dfmhiddenfilecache.h"
+#include "private/dfilenamematcher_p.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QQueue>
+#include <QReadWriteLock>
+#include <QSaveFile>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QStorageInfo>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+DFM_BEGIN_NAMESPACE
+
+namespace {
+const char INDEX_MAGIC[8] = {'D', 'F', 'M', 'F', 'N', 'I', 'D', 'X'};
+const quint32 INDEX_VERSION = 2;
+// the index is rebuilt in background if it is older than this (seconds)
+const qint64 REBUILD_INTERVAL = 60 * 60;
+// directory moves/deletions are not tracked, rebuild after this delay (ms)
+const int STALE_REBUILD_DELAY = 60 * 1000;
+// inotify watches are limited, only the shallowest directories are watched
+const int MAX_WATCHED_DIRECTORIES = 4096;
+
+// walking a whole mount takes minutes, the builds get their own thread
+QThreadPool *buildThreadPool()
+{
+    static QThreadPool *pool = nullptr;
+
+    if (!pool) {
+        pool = new QThreadPool;
+        pool->setMaxThreadCount(1);
+    }
+
+    return pool;
+}
+
+enum EntryFlag {
+    DirectoryEntry = 0x01,
+    HiddenEntry = 0x02
+};
+
+struct IndexHeader {
+    char magic[8];
+    quint32 version;
+    quint32 entryCount;
+    quint64 namesSize;
+    qint64 buildTime;
+    quint64 device;
+    quint32 pinyinCount;
+    quint32 reserved;
+    quint64 pinyinSize;
+};
+
+// entries are stored in breadth-first order, the first one is the mount point
+struct IndexEntry {
+    qint32 parent;
+    quint32 nameOffset;
+    quint16 nameLength;
+    quint16 flags;
+};
+
+// the transliteration of the names with chinese characters, sorted by entry,
+// the initials are stored right after the pinyin
+struct PinyinEntry {
+    quint32 entry;
+    quint32 offset;
+    quint16 pinyinLength;
+    quint16 initialsLength;
+};
+
+struct MountIndex {
+    QByteArray rootPath; // without trailing separator, empty for "/"
+    QString indexFilePath;
+
+    QFile file;
+    QByteArray image; // used if the index file could not be mapped
+    const IndexHeader *header = nullptr;
+    const IndexEntry *entries = nullptr;
+    const char *names = nullptr;
+    const PinyinEntry *pinyinEntries = nullptr;
+    const char *pinyins = nullptr;
+
+    // the changes reported by the watcher since the index was built
+    QSet<QByteArray> addedPaths;
+    QSet<QByteArray> removedPaths;
+    // the changes since the running build started, the walk may have passed them
+    QSet<QByteArray> buildAddedPaths;
+    QSet<QByteArray> buildRemovedPaths;
+
+    bool building = false;
+    bool stale = false;
+    mutable QReadWriteLock lock;
+
+    bool isReady() const
+    {
+        return header;
+    }
+
+    // a new index only misses the changes since its build started
+    void takeBuildChanges()
+    {
+        addedPaths.swap(buildAddedPaths);
+        removedPaths.swap(buildRemovedPaths);
+        buildAddedPaths.clear();
+        buildRemovedPaths.clear();
+    }
+
+    // a path below the root may be on another mount that is not in this index
+    bool isOnDevice(const QByteArray &path) const
+    {
+        struct stat st;
+
+        return stat(path.isEmpty() ? "/" : path.constData(), &st) == 0 && header->device == quint64(st.st_dev);
+    }
+
+    void setData(const uchar *data)
+    {
+        header = reinterpret_cast<const IndexHeader *>(data);
+        entries = reinterpret_cast<const IndexEntry *>(data + sizeof(IndexHeader));
+        pinyinEntries = reinterpret_cast<const PinyinEntry *>(entries + header->entryCount);
+        names = reinterpret_cast<const char *>(pinyinEntries + header->pinyinCount);
+        pinyins = names + header->namesSize;
+    }
+
+    QByteArray filePath(qint32 index, bool showHidden, bool *hidden) const
+    {
+        QList<const IndexEntry *> chain;
+
+        for (qint32 i = index; i > 0; i = entries[i].parent) {
+            if (!showHidden && (entries[i].flags & HiddenEntry)) {
+                *hidden = true;
+            }
+
+            chain.prepend(&entries[i]);
+        }
+
+        QByteArray path = rootPath;
+
+        for (const IndexEntry *entry : chain) {
+            path.append('/').append(names + entry->nameOffset, entry->nameLength);
+        }
+
+        return path;
+    }
+
+    bool isRemoved(const QByteArray &path) const
+    {
+        if (removedPaths.isEmpty()) {
+            return false;
+        }
+
+        for (int i = path.size(); i > rootPath.size(); i = path.lastIndexOf('/', i - 1)) {
+            if (removedPaths.contains(path.left(i))) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+typedef QSharedPointer<MountIndex> MountIndexPointer;
+
+static QByteArray formatPath(const QString &path)
+{
+    QByteArray local_path = QDir::cleanPath(path).toLocal8Bit();
+
+    if (local_path.endsWith('/')) {
+        local_path.chop(1);
+    }
+
+    return local_path;
+}
+}
+
+class DFileNameIndexPrivate
+{
+public:
+    explicit DFileNameIndexPrivate(DFileNameIndex *qq);
+
+    MountIndexPointer findMount(const QByteArray &path) const;
+    bool loadIndex(const MountIndexPointer &mount);
+    bool buildIndex(const MountIndexPointer &mount);
+    void startBuild(const MountIndexPointer &mount);
+    void watchDirectories(const MountIndexPointer &mount);
+
+    void onFileCreated(const QString &path, const QString &name);
+    void onFileDeleted(const QString &path, const QString &name);
+    void onFileMoved(const QString &fromPath, const QString &fromName,
+                     const QString &toPath, const QString &toName);
+    void markStale(const MountIndexPointer &mount);
+
+    DFileNameIndex *q_ptr;
+
+    mutable QReadWriteLock mountsLock;
+    QHash<QByteArray, MountIndexPointer> mounts;
+
+    DFileSystemWatcher *watcher = nullptr;
+    int watchedCount = 0;
+
+    Q_DECLARE_PUBLIC(DFileNameIndex)
+};
+
+DFileNameIndexPrivate::DFileNameIndexPrivate(DFileNameIndex *qq)
+    : q_ptr(qq)
+{
+
+}
+
+MountIndexPointer DFileNameIndexPrivate::findMount(const QByteArray &path) const
+{
+    QReadLocker locker(&mountsLock);
+    MountIndexPointer mount;
+
+    for (const MountIndexPointer &m : mounts) {
+        if (path != m->rootPath && !path.startsWith(m->rootPath + '/')) {
+            continue;
+        }
+
+        if (!mount || m->rootPath.size() > mount->rootPath.size()) {
+            mount = m;
+        }
+    }
+
+    return mount;
+}
+
+bool DFileNameIndexPrivate::loadIndex(const MountIndexPointer &mount)
+{
+    QScopedPointer<QFile> file(new QFile(mount->indexFilePath));
+
+    if (!file->open(QIODevice::ReadOnly) || file->size() < qint64(sizeof(IndexHeader))) {
+        return false;
+    }
+
+    const uchar *data = file->map(0, file->size());
+
+    if (!data) {
+        return false;
+    }
+
+    const IndexHeader *header = reinterpret_cast<const IndexHeader *>(data);
+    struct stat st;
+
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header->version != INDEX_VERSION
+            || stat(mount->rootPath.isEmpty() ? "/" : mount->rootPath.constData(), &st) != 0
+            || header->device != quint64(st.st_dev)
+            || file->size() != qint64(sizeof(IndexHeader) + header->entryCount * sizeof(IndexEntry)
+                                      + header->pinyinCount * sizeof(PinyinEntry) + header->namesSize + header->pinyinSize)) {
+        qWarning() << "Invalid file name index:" << mount->indexFilePath;
+        return false;
+    }
+
+    QWriteLocker locker(&mount->lock);
+
+    mount->file.close();
+    mount->file.setFileName(file->fileName());
+    mount->file.open(QIODevice::ReadOnly);
+    data = mount->file.map(0, mount->file.size());
+
+    if (!data) {
+        mount->header = nullptr;
+        mount->entries = nullptr;
+        mount->names = nullptr;
+        mount->pinyinEntries = nullptr;
+        mount->pinyins = nullptr;
+
+        return false;
+    }
+
+    mount->image.clear();
+    mount->setData(data);
+    mount->takeBuildChanges();
+
+    return true;
+}
+
+bool DFileNameIndexPrivate::buildIndex(const MountIndexPointer &mount)
+{
+    const QByteArray root_path = mount->rootPath.isEmpty() ? QByteArray("/") : mount->rootPath;
+    struct stat st;
+
+    if (stat(root_path.constData(), &st) != 0) {
+        return false;
+    }
+
+    const dev_t device = st.st_dev;
+    QVector<IndexEntry> entries;
+    QByteArray names;
+    QVector<PinyinEntry> pinyin_entries;
+    QByteArray pinyins;
+    char pinyin[1024];
+    char initials[256];
+    QQueue<QPair<QByteArray, qint32>> directory_queue;
+
+    entries << IndexEntry {-1, 0, 0, DirectoryEntry};
+    directory_queue.enqueue(qMakePair(mount->rootPath, 0));
+
+    while (!directory_queue.isEmpty()) {
+        const QPair<QByteArray, qint32> directory = directory_queue.dequeue();
+        DIR *dir = opendir(directory.first.isEmpty() ? "/" : directory.first.constData());
+
+        if (!dir) {
+            continue;
+        }
+
+        const int dir_fd = dirfd(dir);
+
+        while (struct dirent *entry = readdir(dir)) {
+            const char *name = entry->d_name;
+
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            const size_t name_length = strlen(name);
+            unsigned char type = entry->d_type;
+
+            if (type == DT_UNKNOWN || type == DT_DIR) {
+                if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+
+                type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+            }
+
+            quint16 flags = 0;
+
+            if (type == DT_DIR) {
+                flags |= DirectoryEntry;
+            }
+
+            if (name[0] == '.') {
+                flags |= HiddenEntry;
+            }
+
+            entries << IndexEntry {directory.second, quint32(names.size()), quint16(name_length), flags};
+            names.append(name, int(name_length));
+
+            // only the names with chinese characters have pinyin, which must be non-ascii
+            const char *c = name;
+
+            while (*c && static_cast<uchar>(*c) < 0x80) {
+                ++c;
+            }
+
+            int pinyin_length = 0;
+            int initials_length = 0;
+
+            if (*c && Pinyin::Transliterate(name, int(name_length), pinyin, sizeof(pinyin), &pinyin_length,
+                                            initials, sizeof(initials), &initials_length)) {
+                pinyin_entries << PinyinEntry {quint32(entries.size() - 1), quint32(pinyins.size()),
+                                               quint16(pinyin_length), quint16(initials_length)};
+                pinyins.append(pinyin, pinyin_length).append(initials, initials_length);
+            }
+
+            // don't cross the file system boundary, the other mounts have their own index
+            if (type == DT_DIR && st.st_dev == device) {
+                directory_queue.enqueue(qMakePair(QByteArray(directory.first).append('/').append(name, int(name_length)),
+                                                  qint32(entries.size() - 1)));
+            }
+        }
+
+        closedir(dir);
+    }
+
+    IndexHeader header;
+
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.entryCount = quint32(entries.size());
+    header.namesSize = quint64(names.size());
+    header.buildTime = QDateTime::currentDateTime().toTime_t();
+    header.device = quint64(device);
+    header.pinyinCount = quint32(pinyin_entries.size());
+    header.reserved = 0;
+    header.pinyinSize = quint64(pinyins.size());
+
+    QByteArray image;
+
+    image.reserve(int(sizeof(IndexHeader) + entries.size() * sizeof(IndexEntry) + pinyin_entries.size() * sizeof(PinyinEntry))
+                  + names.size() + pinyins.size());
+    image.append(reinterpret_cast<const char *>(&header), sizeof(IndexHeader));
+    image.append(reinterpret_cast<const char *>(entries.constData()), int(entries.size() * sizeof(IndexEntry)));
+    image.append(reinterpret_cast<const char *>(pinyin_entries.constData()), int(pinyin_entries.size() * sizeof(PinyinEntry)));
+    image.append(names);
+    image.append(pinyins);
+
+    QDir().mkpath(QFileInfo(mount->indexFilePath).absolutePath());
+    QSaveFile file(mount->indexFilePath);
+
+    if (file.open(QIODevice::WriteOnly) && file.write(image) == image.size() && file.commit()) {
+        if (loadIndex(mount)) {
+            return true;
+        }
+    } else {
+        qWarning() << "Failed on save the file name index:" << mount->indexFilePath << file.errorString();
+    }
+
+    // keep the index in memory
+    QWriteLocker locker(&mount->lock);
+
+    mount->file.close();
+    mount->image = image;
+    mount->setData(reinterpret_cast<const uchar *>(mount->image.constData()));
+    mount->takeBuildChanges();
+
+    return true;
+}
+
+void DFileNameIndexPrivate::startBuild(const MountIndexPointer &mount)
+{
+    Q_Q(DFileNameIndex);
+
+    if (mount->building) {
+        return;
+    }
+
+    mount->building = true;
+    mount->stale = false;
+
+    {
+        QWriteLocker locker(&mount->lock);
+
+        mount->buildAddedPaths.clear();
+        mount->buildRemovedPaths.clear();
+    }
+
+    QtConcurrent::run(buildThreadPool(), [this, q, mount] {
+        QElapsedTimer timer;
+
+        timer.start();
+
+        bool ok = buildIndex(mount);
+
+        qDebug() << "Build file name index for" << mount->rootPath << "finished:" << ok << "elapsed:" << timer.elapsed();
+
+        QTimer::singleShot(0, q, [this, q, mount, ok] {
+            mount->building = false;
+
+            if (ok) {
+                watchDirectories(mount);
+                Q_EMIT q->indexReady(QString::fromLocal8Bit(mount->rootPath.isEmpty() ? "/" : mount->rootPath));
+            }
+        });
+    });
+}
+
+void DFileNameIndexPrivate::watchDirectories(const MountIndexPointer &mount)
+{
+    Q_Q(DFileNameIndex);
+
+    if (!watcher) {
+        watcher = new DFileSystemWatcher(q);
+
+        QObject::connect(watcher, &DFileSystemWatcher::fileCreated, q, [this] (const QString &path, const QString &name) {
+            onFileCreated(path, name);
+        });
+        QObject::connect(watcher, &DFileSystemWatcher::fileDeleted, q, [this] (const QString &path, const QString &name) {
+            onFileDeleted(path, name);
+        });
+        QObject::connect(watcher, &DFileSystemWatcher::fileMoved, q, [this] (const QString &fromPath, const QString &fromName,
+                         const QString &toPath, const QString &toName) {
+            onFileMoved(fromPath, fromName, toPath, toName);
+        });
+    }
+
+    QStringList directories;
+    const QByteArray &home_path = formatPath(QDir::homePath());
+    QReadLocker locker(&mount->lock);
+
+    // the entries are in breadth-first order, so the shallowest directories come first,
+    // the directories of the user are searched the most, they are watched before the others
+    for (bool in_home : {true, false}) {
+        for (quint32 i = 0; i < mount->header->entryCount && watchedCount + directories.size() < MAX_WATCHED_DIRECTORIES; ++i) {
+            if (!(mount->entries[i].flags & DirectoryEntry)) {
+                continue;
+            }
+
+            bool hidden = false;
+            const QByteArray &path = mount->filePath(qint32(i), false, &hidden);
+
+            if (hidden || (path == home_path || path.startsWith(home_path + '/')) != in_home) {
+                continue;
+            }
+
+            directories << QString::fromLocal8Bit(path.isEmpty() ? QByteArray("/") : path);
+        }
+    }
+
+    locker.unlock();
+
+    const QStringList &failed = watcher->addPaths(directories);
+
+    watchedCount += directories.size() - failed.size();
+}
+
+void DFileNameIndexPrivate::onFileCreated(const QString &path, const QString &name)
+{
+    const QByteArray &file_path = formatPath(path + QDir::separator() + name);
+    const MountIndexPointer &mount = findMount(file_path);
+
+    if (!mount || (!mount->isReady() && !mount->building)) {
+        return;
+    }
+
+    QWriteLocker locker(&mount->lock);
+
+    mount->removedPaths.remove(file_path);
+    mount->addedPaths.insert(file_path);
+
+    if (mount->building) {
+        mount->buildRemovedPaths.remove(file_path);
+        mount->buildAddedPaths.insert(file_path);
+    }
+
+    locker.unlock();
+
+    const QString &local_file = QString::fromLocal8Bit(file_path);
+
+    if (watchedCount < MAX_WATCHED_DIRECTORIES && QFileInfo(local_file).isDir() && watcher->addPath(local_file)) {
+        ++watchedCount;
+    }
+}
+
+void DFileNameIndexPrivate::onFileDeleted(const QString &path, const QString &name)
+{
+    // the watched directory itself was deleted
+    if (name.isEmpty()) {
+        if (const MountIndexPointer &mount = findMount(formatPath(path))) {
+            markStale(mount);
+        }
+
+        return;
+    }
+
+    const QByteArray &file_path = formatPath(path + QDir::separator() + name);
+    const MountIndexPointer &mount = findMount(file_path);
+
+    if (!mount || (!mount->isReady() && !mount->building)) {
+        return;
+    }
+
+    QWriteLocker locker(&mount->lock);
+
+    mount->addedPaths.remove(file_path);
+    mount->removedPaths.insert(file_path);
+
+    if (mount->building) {
+        mount->buildAddedPaths.remove(file_path);
+        mount->buildRemovedPaths.insert(file_path);
+    }
+}
+
+void DFileNameIndexPrivate::onFileMoved(const QString &fromPath, const QString &fromName,
+                                        const QString &toPath, const QString &toName)
+{
+    onFileDeleted(fromPath, fromName);
+
+    if (!toName.isEmpty()) {
+        onFileCreated(toPath, toName);
+
+        // the content of a moved directory is only known after rebuilding
+        if (QFileInfo(toPath + QDir::separator() + toName).isDir()) {
+            if (const MountIndexPointer &mount = findMount(formatPath(toPath))) {
+                markStale(mount);
+            }
+        }
+    }
+}
+
+void DFileNameIndexPrivate::markStale(const MountIndexPointer &mount)
+{
+    Q_Q(DFileNameIndex);
+
+    if (mount->stale) {
+        return;
+    }
+
+    mount->stale = true;
+
+    QTimer::singleShot(STALE_REBUILD_DELAY, q, [this, mount] {
+        if (mount->stale) {
+            startBuild(mount);
+        }
+    });
+}
+
+DFileNameIndex::DFileNameIndex(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new DFileNameIndexPrivate(this))
+{
+
+}
+
+DFileNameIndex::~DFileNameIndex()
+{
+
+}
+
+DFileNameIndex *DFileNameIndex::instance()
+{
+    static DFileNameIndex *index = [] {
+        DFileNameIndex *index = new DFileNameIndex();
+
+        // the watcher and timers need the event loop of the main thread
+        if (qApp) {
+            index->moveToThread(qApp->thread());
+        }
+
+        return index;
+    }();
+
+    return index;
+}
+
+bool DFileNameIndex::isEnabled() const
+{
+    return DFMApplication::genericAttribute(DFMApplication::GA_BuiltinSearchIndex).toBool();
+}
+
+bool DFileNameIndex::isReady(const QString &path) const
+{
+    Q_D(const DFileNameIndex);
+
+    const MountIndexPointer &mount = d->findMount(formatPath(path));
+
+    if (!mount) {
+        return false;
+    }
+
+    QReadLocker locker(&mount->lock);
+
+    return mount->isReady() && mount->isOnDevice(formatPath(path));
+}
+
+QList<QByteArray> DFileNameIndex::search(const QString &rootPath, const QString &keyword, bool showHidden) const
+{
+    Q_D(const DFileNameIndex);
+
+    const QByteArray &root_path = formatPath(rootPath);
+    const MountIndexPointer &mount = d->findMount(root_path);
+    QList<QByteArray> result;
+
+    if (!mount) {
+        return result;
+    }
+
+    DFileNameMatcher matcher;
+    QHash<QByteArray, DFMHiddenFileCache::HiddenNames> hidden_files;
+
+    matcher.setKeyword(keyword);
+
+    // the deep directories are not watched, so the index may be outdated
+    auto isInvalid = [&] (const QByteArray &filePath) {
+        struct stat st;
+
+        if (lstat(filePath.constData(), &st) != 0) {
+            return true;
+        }
+
+        const int index = filePath.lastIndexOf('/');
+        const QByteArray &dir_path = index > 0 ? filePath.left(index) : QByteArray("/");
+        const QString &dir = QString::fromLocal8Bit(dir_path);
+        const QString &name = QString::fromLocal8Bit(filePath.mid(index + 1));
+
+        if (FileController::privateFileMatch(dir, name)) {
+            return true;
+        }
+
+        if (showHidden) {
+            return false;
+        }
+
+        // stat the .hidden file once for each directory in a search
+        auto it = hidden_files.find(dir_path);
+
+        if (it == hidden_files.end()) {
+            it = hidden_files.insert(dir_path, DFMHiddenFileCache::instance()->hiddenNames(dir_path));
+        }
+
+        return it->contains(filePath.constData() + index + 1, filePath.size() - index - 1)
+                || FileController::customHiddenFileMatch(dir, name);
+    };
+
+    QReadLocker locker(&mount->lock);
+
+    if (!mount->isReady() || !mount->isOnDevice(root_path)) {
+        return result;
+    }
+
+    const QByteArray &prefix = root_path + '/';
+    const bool match_pinyin = matcher.hasPinyinKeyword();
+    quint32 p = 0;
+
+    for (quint32 i = 1; i < mount->header->entryCount; ++i) {
+        const IndexEntry &entry = mount->entries[i];
+
+        if (!matcher.matchName(mount->names + entry.nameOffset, entry.nameLength)) {
+            if (!match_pinyin) {
+                continue;
+            }
+
+            // both are sorted by entry
+            while (p < mount->header->pinyinCount && mount->pinyinEntries[p].entry < i) {
+                ++p;
+            }
+
+            if (p == mount->header->pinyinCount || mount->pinyinEntries[p].entry != i) {
+                continue;
+            }
+
+            const PinyinEntry &pinyin = mount->pinyinEntries[p];
+            const char *data = mount->pinyins + pinyin.offset;
+
+            if (!matcher.matchPinyin(data, pinyin.pinyinLength, data + pinyin.pinyinLength, pinyin.initialsLength)) {
+                continue;
+            }
+        }
+
+        bool hidden = false;
+        const QByteArray &file_path = mount->filePath(qint32(i), showHidden, &hidden);
+
+        if (hidden || !file_path.startsWith(prefix) || mount->isRemoved(file_path)) {
+            continue;
+        }
+
+        result << file_path;
+    }
+
+    // a file created while the index was built may be in both
+    const QSet<QByteArray> indexed_result = mount->addedPaths.isEmpty() ? QSet<QByteArray>() : result.toSet();
+
+    for (const QByteArray &file_path : mount->addedPaths) {
+        if (!file_path.startsWith(prefix) || indexed_result.contains(file_path)) {
+            continue;
+        }
+
+        const QByteArray &name = file_path.mid(file_path.lastIndexOf('/') + 1);
+
+        if (!showHidden && (name.startsWith('.') || file_path.mid(prefix.size()).contains("/."))) {
+            continue;
+        }
+
+        // the added files have no pinyin in the index, it's transliterated here
+        if (matcher.matchName(name.constData(), size_t(name.size()))
+                || (match_pinyin && matcher.matchPinyinOf(name.constData(), size_t(name.size())))) {
+            result << file_path;
+        }
+    }
+
+    const bool need_rebuild = mount->header->buildTime + REBUILD_INTERVAL < QDateTime::currentDateTime().toTime_t();
+
+    locker.unlock();
+
+    if (need_rebuild) {
+        QMetaObject::invokeMethod(const_cast<DFileNameIndex *>(this), "prepare", Qt::QueuedConnection, Q_ARG(QString, rootPath));
+    }
+
+    result.erase(std::remove_if(result.begin(), result.end(), isInvalid), result.end());
+
+    std::stable_sort(result.begin(), result.end(), [] (const QByteArray &p1, const QByteArray &p2) {
+        return p1.count('/') < p2.count('/');
+    });
+
+    return result;
+}
+
+void DFileNameIndex::prepare(const QString &path)
+{
+    Q_D(DFileNameIndex);
+
+    if (!isEnabled()) {
+        return;
+    }
+
+    QStorageInfo storage_info(path);
+
+    // only the internal disks are indexed, the removable and network
+    // devices are left to the deepin-anything settings
+    if (!storage_info.isValid() || !storage_info.device().startsWith("/dev/")) {
+        return;
+    }
+
+    const QString &root_path = storage_info.rootPath();
+
+    if (root_path != "/" && !QDir::homePath().startsWith(root_path)) {
+        return;
+    }
+
+    const QByteArray &mount_path = formatPath(root_path);
+    MountIndexPointer mount;
+
+    {
+        QWriteLocker locker(&d->mountsLock);
+
+        mount = d->mounts.value(mount_path);
+
+        if (!mount) {
+            mount.reset(new MountIndex());
+            mount->rootPath = mount_path;
+            mount->indexFilePath = DFMStandardPaths::location(DFMStandardPaths::CachePath) + "/index/"
+                                   + QCryptographicHash::hash(mount_path, QCryptographicHash::Md5).toHex() + ".idx";
+            d->mounts[mount_path] = mount;
+        }
+    }
+
+    if (mount->building) {
+        return;
+    }
+
+    if (!mount->isReady() && d->loadIndex(mount)) {
+        d->watchDirectories(mount);
+        Q_EMIT indexReady(root_path);
+    }
+
+    if (!mount->isReady() || mount->header->buildTime + REBUILD_INTERVAL < QDateTime::currentDateTime().toTime_t()) {
+        d->startBuild(mount);
+    }
+}
+
+DFM_END_NAMESPACE
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DFILENAMEINDEX_H
+#define DFILENAMEINDEX_H
+
+#include <dfmglobal.h>
+
+#include <QObject>
+
+DFM_BEGIN_NAMESPACE
+
+class DFileNameIndexPrivate;
+class DFileNameIndex : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(DFileNameIndex)
+
+public:
+    static DFileNameIndex *instance();
+
+    bool isEnabled() const;
+    // the index of the mount which contains the path is loaded and can be searched
+    bool isReady(const QString &path) const;
+
+    // Returns the local 8bit encoded paths under rootPath which file name matches
+    // the keyword, shallow files first. Returns nothing if the index is not ready.
+    QList<QByteArray> search(const QString &rootPath, const QString &keyword, bool showHidden) const;
+
+public Q_SLOTS:
+    // load the saved index of the mount which contains the path, or build it in background
+    void prepare(const QString &path);
+
+Q_SIGNALS:
+    void indexReady(const QString &mountPoint);
+
+private:
+    explicit DFileNameIndex(QObject *parent = nullptr);
+    ~DFileNameIndex();
+
+    QScopedPointer<DFileNameIndexPrivate> d_ptr;
+};
+
+DFM_END_NAMESPACE
+
+#endif // DFILENAMEINDEX_H
@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dlocalsearchengine.h"
+#include "dfileservices.h"
+#include "dabstractfileinfo.h"
+#include "controllers/filecontroller.h"
+#include "shutil/dfmhiddenfilecache.h"
+#include "private/dfilenamematcher_p.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QQueue>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrent>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+
+DFM_BEGIN_NAMESPACE
+
+namespace {
+// upper limit of the traversal threads, more threads only thrash the disk
+const int MAX_THREAD_COUNT = 4;
+
+struct DirectoryEntry {
+    QByteArray path;
+    int depth;
+};
+}
+
+class DLocalSearchEnginePrivate
+{
+public:
+    explicit DLocalSearchEnginePrivate(DLocalSearchEngine *qq);
+
+    void work();
+    void scanDirectory(const DirectoryEntry &directory, QList<DirectoryEntry> &subdirectories,
+                       QList<DLocalSearchEngine::Match> &matches);
+    bool isHiddenEntry(const QByteArray &dirPath, const char *name, int nameLength,
+                       const DFMHiddenFileCache::HiddenNames &hiddenNames) const;
+    bool displayNameMatch(const QByteArray &filePath) const;
+    int settledDepth() const;
+    bool hasSettledMatches() const;
+
+    DLocalSearchEngine *q_ptr;
+
+    QThreadPool threadPool;
+    DFileNameMatcher matcher;
+    bool showHidden = false;
+
+    mutable QMutex mutex;
+    QWaitCondition queueCondition;
+    QWaitCondition matchCondition;
+    QQueue<DirectoryEntry> directoryQueue;
+    // the number of the queued or scanning directories per depth
+    QVector<int> openDirectories;
+    // the matches by depth, a depth is delivered once no directory above it is open
+    QMap<int, QList<DLocalSearchEngine::Match>> pendingMatches;
+    int busyWorkers = 0;
+    int runningWorkers = 0;
+
+    QAtomicInt stopped = 0;
+    bool running = false;
+
+    Q_DECLARE_PUBLIC(DLocalSearchEngine)
+};
+
+DLocalSearchEnginePrivate::DLocalSearchEnginePrivate(DLocalSearchEngine *qq)
+    : q_ptr(qq)
+{
+    threadPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), MAX_THREAD_COUNT));
+}
+
+void DLocalSearchEnginePrivate::work()
+{
+    QList<DirectoryEntry> subdirectories;
+    QList<DLocalSearchEngine::Match> matches;
+
+    forever {
+        DirectoryEntry directory;
+
+        {
+            QMutexLocker locker(&mutex);
+
+            while (directoryQueue.isEmpty() && busyWorkers > 0 && !stopped.load()) {
+                queueCondition.wait(&mutex);
+            }
+
+            if (directoryQueue.isEmpty() || stopped.load()) {
+                break;
+            }
+
+            directory = directoryQueue.dequeue();
+            ++busyWorkers;
+        }
+
+        scanDirectory(directory, subdirectories, matches);
+
+        QMutexLocker locker(&mutex);
+
+        const bool had_settled_matches = hasSettledMatches();
+
+        for (const DirectoryEntry &entry : subdirectories) {
+            if (openDirectories.count() <= entry.depth) {
+                openDirectories.resize(entry.depth + 1);
+            }
+
+            ++openDirectories[entry.depth];
+            directoryQueue.enqueue(entry);
+        }
+
+        for (const DLocalSearchEngine::Match &match : matches) {
+            pendingMatches[match.depth] << match;
+        }
+
+        subdirectories.clear();
+        matches.clear();
+        --openDirectories[directory.depth];
+        --busyWorkers;
+
+        // wake up the idle workers for the new directories, or let them quit if the tree is done
+        queueCondition.wakeAll();
+
+        if (!had_settled_matches && hasSettledMatches()) {
+            matchCondition.wakeAll();
+            locker.unlock();
+
+            Q_EMIT q_ptr->matchesAvailable();
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+
+    queueCondition.wakeAll();
+
+    if (--runningWorkers == 0) {
+        running = false;
+        matchCondition.wakeAll();
+        locker.unlock();
+
+        Q_EMIT q_ptr->finished();
+    }
+}
+
+void DLocalSearchEnginePrivate::scanDirectory(const DirectoryEntry &directory, QList<DirectoryEntry> &subdirectories,
+                                              QList<DLocalSearchEngine::Match> &matches)
+{
+    DIR *dir = opendir(directory.path.constData());
+
+    if (!dir) {
+        return;
+    }
+
+    const int dir_fd = dirfd(dir);
+    const QByteArray dir_path = directory.path.endsWith('/') ? directory.path : directory.path + '/';
+    DFMHiddenFileCache::HiddenNames hidden_names;
+
+    // the parsed .hidden files are shared with the other searches and the views
+    if (!showHidden) {
+        hidden_names = DFMHiddenFileCache::instance()->hiddenNames(directory.path);
+    }
+
+    while (struct dirent *entry = readdir(dir)) {
+        if (stopped.load()) {
+            break;
+        }
+
+        const char *name = entry->d_name;
+
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        if (!showHidden && name[0] == '.') {
+            continue;
+        }
+
+        const size_t name_length = strlen(name);
+        unsigned char type = entry->d_type;
+        qint64 last_modified = -1;
+
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+
+            if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : DT_REG;
+            last_modified = st.st_mtime;
+        }
+
+        bool matched = matcher.match(name, name_length);
+
+        if (!matched && type != DT_DIR) {
+            // the display name of a desktop file is not its file name
+            if (name_length > 8 && strcmp(name + name_length - 8, ".desktop") == 0) {
+                matched = displayNameMatch(QByteArray(dir_path).append(name));
+            }
+
+            if (!matched) {
+                continue;
+            }
+        }
+
+        // symbolic links are never followed, same as the old iterator
+        if (isHiddenEntry(dir_path, name, name_length, hidden_names)) {
+            continue;
+        }
+
+        QByteArray file_path = dir_path;
+        file_path.append(name, static_cast<int>(name_length));
+
+        if (type == DT_DIR) {
+            subdirectories << DirectoryEntry {file_path, directory.depth + 1};
+        }
+
+        if (matched) {
+            if (last_modified < 0) {
+                struct stat st;
+
+                last_modified = fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0 ? st.st_mtime : 0;
+            }
+
+            matches << DLocalSearchEngine::Match {file_path, directory.depth + 1, last_modified};
+        }
+    }
+
+    closedir(dir);
+}
+
+bool DLocalSearchEnginePrivate::isHiddenEntry(const QByteArray &dirPath, const char *name, int nameLength,
+                                              const DFMHiddenFileCache::HiddenNames &hiddenNames) const
+{
+    if (!showHidden && hiddenNames.contains(name, nameLength)) {
+        return true;
+    }
+
+    const QString &file_name = QString::fromLocal8Bit(name);
+    QString path = QString::fromLocal8Bit(dirPath);
+
+    // same as QFileInfo::absolutePath
+    if (path.size() > 1) {
+        path.chop(1);
+    }
+
+    if (FileController::privateFileMatch(path, file_name)) {
+        return true;
+    }
+
+    if (showHidden) {
+        return false;
+    }
+
+    return FileController::customHiddenFileMatch(path, file_name);
+}
+
+bool DLocalSearchEnginePrivate::displayNameMatch(const QByteArray &filePath) const
+{
+    const DAbstractFileInfoPointer &info = DFileService::instance()->createFileInfo(nullptr, DUrl::fromLocalFile(QString::fromLocal8Bit(filePath)));
+
+    return info && matcher.matchString(info->fileDisplayName());
+}
+
+// the matches of a depth come from the directories one level above, they are all
+// known once those directories are scanned. must be called with the mutex locked
+int DLocalSearchEnginePrivate::settledDepth() const
+{
+    if (!running || stopped.load()) {
+        return INT_MAX;
+    }
+
+    for (int depth = 0; depth < openDirectories.count(); ++depth) {
+        if (openDirectories.at(depth) > 0) {
+            return depth;
+        }
+    }
+
+    return INT_MAX;
+}
+
+bool DLocalSearchEnginePrivate::hasSettledMatches() const
+{
+    return !pendingMatches.isEmpty() && pendingMatches.firstKey() <= settledDepth();
+}
+
+DLocalSearchEngine::DLocalSearchEngine(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new DLocalSearchEnginePrivate(this))
+{
+
+}
+
+DLocalSearchEngine::~DLocalSearchEngine()
+{
+    Q_D(DLocalSearchEngine);
+
+    stop();
+    d->threadPool.waitForDone();
+}
+
+void DLocalSearchEngine::setShowHidden(bool showHidden)
+{
+    Q_D(DLocalSearchEngine);
+    Q_ASSERT(!isRunning());
+
+    d->showHidden = showHidden;
+}
+
+void DLocalSearchEngine::setThreadCount(int count)
+{
+    Q_D(DLocalSearchEngine);
+    Q_ASSERT(!isRunning());
+
+    d->threadPool.setMaxThreadCount(qMax(1, count));
+}
+
+bool DLocalSearchEngine::start(const QString &rootPath, const QString &keyword)
+{
+    Q_D(DLocalSearchEngine);
+
+    if (isRunning()) {
+        return false;
+    }
+
+    d->threadPool.waitForDone();
+
+    const QByteArray &root_path = rootPath.toLocal8Bit();
+    struct stat st;
+
+    if (stat(root_path.constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    d->matcher.setKeyword(keyword);
+    d->stopped = 0;
+
+    QMutexLocker locker(&d->mutex);
+
+    d->directoryQueue.clear();
+    d->directoryQueue.enqueue(DirectoryEntry {root_path, 0});
+    d->openDirectories = QVector<int>(1, 1);
+    d->pendingMatches.clear();
+    d->busyWorkers = 0;
+    d->runningWorkers = d->threadPool.maxThreadCount();
+    d->running = true;
+
+    for (int i = 0; i < d->runningWorkers; ++i) {
+        QtConcurrent::run(&d->threadPool, [d] {
+            d->work();
+        });
+    }
+
+    return true;
+}
+
+void DLocalSearchEngine::stop()
+{
+    Q_D(DLocalSearchEngine);
+
+    d->stopped = 1;
+
+    QMutexLocker locker(&d->mutex);
+
+    d->queueCondition.wakeAll();
+    d->matchCondition.wakeAll();
+}
+
+bool DLocalSearchEngine::isRunning() const
+{
+    Q_D(const DLocalSearchEngine);
+
+    QMutexLocker locker(&d->mutex);
+
+    return d->running;
+}
+
+bool DLocalSearchEngine::isFinished() const
+{
+    Q_D(const DLocalSearchEngine);
+
+    QMutexLocker locker(&d->mutex);
+
+    return !d->running && d->pendingMatches.isEmpty();
+}
+
+QList<DLocalSearchEngine::Match> DLocalSearchEngine::takeMatches(int timeout)
+{
+    Q_D(DLocalSearchEngine);
+
+    QMutexLocker locker(&d->mutex);
+
+    if (!d->hasSettledMatches() && d->running && !d->stopped.load()) {
+        d->matchCondition.wait(&d->mutex, timeout < 0 ? ULONG_MAX : static_cast<unsigned long>(timeout));
+    }
+
+    // only the complete depths are taken, so the matches of all the calls together
+    // are in the same order as if they were ranked at once
+    const int settled_depth = d->settledDepth();
+    QList<QList<Match>> depths;
+
+    while (!d->pendingMatches.isEmpty() && d->pendingMatches.firstKey() <= settled_depth) {
+        depths << d->pendingMatches.take(d->pendingMatches.firstKey());
+    }
+
+    locker.unlock();
+
+    QList<Match> matches;
+
+    for (QList<Match> &depth_matches : depths) {
+        std::stable_sort(depth_matches.begin(), depth_matches.end(), [] (const Match &m1, const Match &m2) {
+            return m1.lastModified > m2.lastModified;
+        });
+
+        matches.append(depth_matches);
+    }
+
+    return matches;
+}
+
+DFM_END_NAMESPACE
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DLOCALSEARCHENGINE_H
+#define DLOCALSEARCHENGINE_H
+
+#include <dfmglobal.h>
+
+#include <QObject>
+
+DFM_BEGIN_NAMESPACE
+
+class DLocalSearchEnginePrivate;
+class DLocalSearchEngine : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(DLocalSearchEngine)
+
+public:
+    struct Match {
+        QByteArray filePath; // local 8bit encoded absolute path
+        int depth;           // depth relative to the search root, the root itself is 0
+        qint64 lastModified; // seconds since epoch
+    };
+
+    explicit DLocalSearchEngine(QObject *parent = nullptr);
+    ~DLocalSearchEngine();
+
+    // must be called before start
+    void setShowHidden(bool showHidden);
+    void setThreadCount(int count);
+
+    bool start(const QString &rootPath, const QString &keyword);
+    void stop();
+
+    bool isRunning() const;
+    bool isFinished() const;
+
+    // Blocks until matches are available, the search is finished or stopped or the
+    // timeout (ms, -1 for infinite) expired. The matches are ranked by depth first and
+    // then by recency, a depth is only returned once it is complete, so the results of
+    // the successive calls are ranked across the whole search.
+    QList<Match> takeMatches(int timeout = -1);
+
+Q_SIGNALS:
+    void matchesAvailable();
+    void finished();
+
+private:
+    QScopedPointer<DLocalSearchEnginePrivate> d_ptr;
+};
+
+DFM_END_NAMESPACE
+
+#endif // DLOCALSEARCHENGINE_H
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dwritebackthrottle.h"
+
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+
+#define MIN_WINDOW_SIZE (1024 * 1024)
+#define MAX_WINDOW_SIZE (32 * 1024 * 1024)
+#define START_WINDOW_SIZE (4 * 1024 * 1024)
+#define MIN_BLOCK_SIZE (64 * 1024)
+
+DFM_BEGIN_NAMESPACE
+
+DWriteBackThrottle::DWriteBackThrottle()
+    : m_windowSize(START_WINDOW_SIZE)
+    , m_speed(0)
+{
+
+}
+
+void DWriteBackThrottle::reset()
+{
+    m_fd = -1;
+    m_windowSize = START_WINDOW_SIZE;
+    m_supported = true;
+    m_speed.store(0);
+}
+
+void DWriteBackThrottle::beginFile(int fd)
+{
+    m_fd = m_supported ? fd : -1;
+    m_syncedPos = 0;
+    m_waitedPos = 0;
+}
+
+void DWriteBackThrottle::fileWritten(qint64 pos)
+{
+    if (m_fd < 0 || pos - m_syncedPos < m_windowSize) {
+        return;
+    }
+
+    if (sync_file_range(m_fd, m_syncedPos, pos - m_syncedPos, SYNC_FILE_RANGE_WRITE) != 0) {
+        // not a regular file or a file system without write back, such as a pipe or some fuse mounts
+        if (errno == EINVAL || errno == ESPIPE) {
+            qWarning() << "sync_file_range is not supported by the target, the write back is not throttled";
+
+            m_supported = false;
+            m_fd = -1;
+        }
+
+        return;
+    }
+
+    if (m_syncedPos > m_waitedPos) {
+        sync_file_range(m_fd, m_waitedPos, m_syncedPos - m_waitedPos,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+
+        // the first wait of a file covers the time of writing two windows, not measured
+        if (m_waitedPos > 0 && m_timer.isValid()) {
+            const qint64 elapsed = qMax(m_timer.elapsed(), qint64(1));
+            const qint64 speed = (m_syncedPos - m_waitedPos) * 1000 / elapsed;
+            const qint64 old_speed = m_speed.load();
+
+            // smoothed, the eta computed from it doesn't jump around
+            m_speed.store(old_speed > 0 ? (old_speed * 3 + speed) / 4 : speed);
+            m_windowSize = qBound(qint64(MIN_WINDOW_SIZE), m_speed.load() / 4 / MIN_WINDOW_SIZE * MIN_WINDOW_SIZE, qint64(MAX_WINDOW_SIZE));
+        }
+
+        m_timer.start();
+        m_waitedPos = m_syncedPos;
+    }
+
+    m_syncedPos = pos;
+}
+
+void DWriteBackThrottle::endFile()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    // nbytes is 0, until the end of the file
+    sync_file_range(m_fd, m_syncedPos, 0, SYNC_FILE_RANGE_WRITE);
+    m_fd = -1;
+}
+
+qint64 DWriteBackThrottle::speed() const
+{
+    return m_speed.load();
+}
+
+int DWriteBackThrottle::blockSize(int maxBlockSize) const
+{
+    return int(qBound(qint64(qMin(MIN_BLOCK_SIZE, maxBlockSize)), m_windowSize / 4, qint64(maxBlockSize)));
+}
+
+DFM_END_NAMESPACE
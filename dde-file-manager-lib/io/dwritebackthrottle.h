@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DWRITEBACKTHROTTLE_H
+#define DWRITEBACKTHROTTLE_H
+
+#include <dfmglobal.h>
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+DFM_BEGIN_NAMESPACE
+
+// Limits the dirty pages of the file being written. Once a window of data is
+// written, the kernel is asked to start writing it back, and the previous window
+// is waited for, so at most two windows are dirty. The window size follows the
+// measured write speed of the device, a window takes about a quarter second.
+// Only the speed() may be called from other threads.
+class DWriteBackThrottle
+{
+public:
+    DWriteBackThrottle();
+
+    // forget the measured speed, for a new target device
+    void reset();
+
+    void beginFile(int fd);
+    // the file is written up to pos, may block until the previous window is written back
+    void fileWritten(qint64 pos);
+    // start writing back the rest of the file, doesn't wait
+    void endFile();
+
+    // bytes per second written to the device, 0 if not measured yet
+    qint64 speed() const;
+    // the size of a read/write, smaller blocks for the slower devices
+    int blockSize(int maxBlockSize) const;
+
+private:
+    int m_fd = -1;
+    // the write back is started up to m_syncedPos and done up to m_waitedPos
+    qint64 m_syncedPos = 0;
+    qint64 m_waitedPos = 0;
+    qint64 m_windowSize;
+    // false once the target doesn't support sync_file_range, until the next reset
+    bool m_supported = true;
+    QAtomicInteger<qint64> m_speed;
+    QElapsedTimer m_timer;
+};
+
+DFM_END_NAMESPACE
+
+#endif // DWRITEBACKTHROTTLE_H
@@ -9,7 +9,10 @@ HEADERS += \
     $$PWD/dlocalfilehandler.h \
     $$PWD/dfilestatisticsjob.h \
     $$PWD/dstorageinfo.h \
-    $$PWD/dgiofiledevice.h
+    $$PWD/dgiofiledevice.h \
+    $$PWD/dlocalsearchengine.h \
+    $$PWD/dfilenameindex.h \
+    $$PWD/dwritebackthrottle.h
 
 SOURCES += \
     $$PWD/dlocalfiledevice.cpp \
@@ -20,6 +23,9 @@ SOURCES += \
     $$PWD/dlocalfilehandler.cpp \
     $$PWD/dfilestatisticsjob.cpp \
     $$PWD/dstorageinfo.cpp \
-    $$PWD/dgiofiledevice.cpp
+    $$PWD/dgiofiledevice.cpp \
+    $$PWD/dlocalsearchengine.cpp \
+    $$PWD/dfilenameindex.cpp \
+    $$PWD/dwritebackthrottle.cpp
 
 include(private/private.pri)
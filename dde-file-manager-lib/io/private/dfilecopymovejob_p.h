@@ -23,6 +23,7 @@
 
 #include "dfilecopymovejob.h"
 #include "dstorageinfo.h"
+#include "dwritebackthrottle.h"
 
 #include <QWaitCondition>
 #include <QPointer>
@@ -34,6 +35,7 @@ typedef QExplicitlySharedDataPointer<DAbstractFileInfo> DAbstractFileInfoPointer
 DFM_BEGIN_NAMESPACE
 
 class DFileHandler;
+class DFileDevice;
 class DFileStatisticsJob;
 class ElapsedTimer;
 class DFileCopyMoveJobPrivate
@@ -86,6 +88,9 @@ public:
 
     bool doProcess(const DUrl &from, DAbstractFileInfoPointer source_info, const DAbstractFileInfo *target_info);
     bool mergeDirectory(DFileHandler *handler, const DAbstractFileInfo *fromInfo, const DAbstractFileInfo *toInfo);
+    // 返回按页对齐的缓冲区，大小不够时才重新分配
+    char *getDataBuffer(int size);
+    static DFileDevice *createFileDevice(const DUrl &url, const DStorageInfo &storageInfo);
     bool doCopyFile(const DAbstractFileInfo *fromInfo, const DAbstractFileInfo *toInfo, int blockSize = 1048576);
     bool doRemoveFile(DFileHandler *handler, const DAbstractFileInfo *fileInfo);
     bool doRenameFile(DFileHandler *handler, const DAbstractFileInfo *oldInfo, const DAbstractFileInfo *newInfo);
@@ -135,6 +140,8 @@ public:
     QString targetSysDevPath;
     // 目标设备所挂载的根目录
     QString targetRootPath;
+    // 目标为可移除设备时，限制脏页数量并测量设备的写入速度
+    DWriteBackThrottle writeBackThrottle;
 
     QPointer<QThread> threadOfErrorHandle;
     DFileCopyMoveJob::Action actionOfError[DFileCopyMoveJob::UnknowError] = {DFileCopyMoveJob::NoAction};
@@ -143,6 +150,7 @@ public:
     QStack<JobInfo> jobStack;
     QStack<DirectoryInfo> directoryStack;
     QList<QPair<DUrl, DUrl>> completedFileList;
+    QHash<DUrl, quint32> completedFileChecksums;
     QList<QPair<DUrl, DUrl>> completedDirectoryList;
     int completedFilesCount = 0;
     qint64 completedDataSize = 0;
@@ -150,6 +158,9 @@ public:
     qint64 completedDataSizeOnBlockDevice = 0;
     QPair<qint64 /*total*/, qint64 /*writed*/> currentJobDataSizeInfo;
     int currentJobFileHandle = -1;
+    // 复制文件时使用的缓冲区，可用于 O_DIRECT
+    char *dataBuffer = nullptr;
+    int dataBufferSize = 0;
     ElapsedTimer *updateSpeedElapsedTimer = nullptr;
     QTimer *updateSpeedTimer = nullptr;
     int timeOutCount = 0;
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DFILENAMEMATCHER_P_H
+#define DFILENAMEMATCHER_P_H
+
+#include "dfmglobal.h"
+#include "shutil/dfmregularexpression.h"
+#include "chinese2pinyin.h"
+
+#include <QRegularExpression>
+
+DFM_BEGIN_NAMESPACE
+
+// Matches the search keyword against raw local 8bit file names, used by the
+// local search engine and the file name index. A keyword of ascii letters also
+// matches the full pinyin and the pinyin initials of chinese names ("wd" -> 文档).
+class DFileNameMatcher
+{
+public:
+    void setKeyword(const QString &keyword)
+    {
+        regex = QRegularExpression(DFMRegularExpression::checkWildcardAndToRegularExpression(keyword),
+                                   QRegularExpression::CaseInsensitiveOption);
+        literal = !keyword.contains('*') && !keyword.contains('?');
+        pinyinKeyword.clear();
+
+        // the bytes can only be compared directly if the case insensitive matching
+        // does not depend on the unicode case folding
+        for (const QChar &c : keyword) {
+            if (c.unicode() >= 0x80 && (c.toLower() != c || c.toUpper() != c)) {
+                literal = false;
+                break;
+            }
+        }
+
+        if (literal) {
+            // QByteArray::toLower() is latin-1 aware and would change the utf-8 bytes
+            bytes = keyword.toUtf8();
+
+            for (char &c : bytes) {
+                c = toLowerAscii(c);
+            }
+        }
+
+        if (literal && keyword.size() >= 2) {
+            bool letters = true;
+
+            for (const QChar &c : keyword) {
+                if (c.unicode() >= 0x80 || !c.isLetter()) {
+                    letters = false;
+                    break;
+                }
+            }
+
+            if (letters) {
+                pinyinKeyword = bytes;
+            }
+        }
+    }
+
+    bool hasPinyinKeyword() const
+    {
+        return !pinyinKeyword.isEmpty();
+    }
+
+    bool match(const char *name, size_t length) const
+    {
+        return matchName(name, length) || matchPinyinOf(name, length);
+    }
+
+    // matches the name only, without its pinyin
+    bool matchName(const char *name, size_t length) const
+    {
+        if (literal) {
+            return contains(name, length, bytes);
+        }
+
+        return regex.match(QString::fromLocal8Bit(name, static_cast<int>(length))).hasMatch();
+    }
+
+    // transliterates the name on the fly, no memory is allocated
+    bool matchPinyinOf(const char *name, size_t length) const
+    {
+        if (pinyinKeyword.isEmpty()) {
+            return false;
+        }
+
+        size_t i = 0;
+
+        while (i < length && static_cast<uchar>(name[i]) < 0x80) {
+            ++i;
+        }
+
+        // a pure ascii name has no pinyin
+        if (i == length) {
+            return false;
+        }
+
+        char pinyin[1024];
+        char initials[256];
+        int pinyin_length = 0;
+        int initials_length = 0;
+
+        if (!Pinyin::Transliterate(name, static_cast<int>(length), pinyin, sizeof(pinyin), &pinyin_length,
+                                   initials, sizeof(initials), &initials_length)) {
+            return false;
+        }
+
+        return matchPinyin(pinyin, pinyin_length, initials, initials_length);
+    }
+
+    // matches the transliteration of a name, see Pinyin::Transliterate
+    bool matchPinyin(const char *pinyin, int pinyinLength, const char *initials, int initialsLength) const
+    {
+        if (pinyinKeyword.isEmpty()) {
+            return false;
+        }
+
+        return contains(pinyin, static_cast<size_t>(pinyinLength), pinyinKeyword)
+                || contains(initials, static_cast<size_t>(initialsLength), pinyinKeyword);
+    }
+
+    bool matchString(const QString &name) const
+    {
+        return regex.match(name).hasMatch();
+    }
+
+private:
+    static inline char toLowerAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+
+    // ascii case insensitive, the keyword must be lower-cased
+    static bool contains(const char *text, size_t length, const QByteArray &keyword)
+    {
+        const size_t keywordLength = static_cast<size_t>(keyword.size());
+
+        if (keywordLength == 0) {
+            return true;
+        }
+
+        if (keywordLength > length) {
+            return false;
+        }
+
+        const char *key = keyword.constData();
+
+        for (size_t i = 0; i <= length - keywordLength; ++i) {
+            size_t j = 0;
+
+            while (j < keywordLength && toLowerAscii(text[i + j]) == key[j]) {
+                ++j;
+            }
+
+            if (j == keywordLength) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool literal = false;
+    QByteArray bytes;
+    QByteArray pinyinKeyword;
+    QRegularExpression regex;
+};
+
+DFM_END_NAMESPACE
+
+#endif // DFILENAMEMATCHER_P_H
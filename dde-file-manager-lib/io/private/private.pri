@@ -3,4 +3,5 @@ HEADERS += \
     $$PWD/dfileiodeviceproxy_p.h \
     $$PWD/dfilecopymovejob_p.h \
     $$PWD/dfiledevice_p.h \
-    $$PWD/dfilehandler_p.h
+    $$PWD/dfilehandler_p.h \
+    $$PWD/dfilenamematcher_p.h
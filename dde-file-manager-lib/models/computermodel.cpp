@@ -26,15 +26,77 @@
 #include "dfileservices.h"
 #include "dabstractfileinfo.h"
 
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QSet>
 #include <QStorageInfo>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <sys/statvfs.h>
 
 #include "views/computerview.h"
 #include "shutil/fileutils.h"
 #include "computermodel.h"
 
+// the usage of the mounted file systems is refreshed at this interval
+#define PROBE_INTERVAL 5000
+// a probe not finished in time keeps the last known value, the mount is
+// then only probed every SLOW_PROBE_TICKS intervals
+#define PROBE_TIMEOUT 2000
+#define SLOW_PROBE_TICKS 6
+#define MAX_PROBE_THREADS 4
+
+namespace {
+struct FileSystemUsage
+{
+    bool valid = false;
+    quint64 used = 0;
+    quint64 total = 0;
+};
+
+// statvfs of a dead network mount may block for minutes and can't be interrupted,
+// the probes run on their own threads which never block the gui or the exit
+QThreadPool *probeThreadPool()
+{
+    static QThreadPool *pool = nullptr;
+
+    if (!pool) {
+        pool = new QThreadPool;
+        pool->setMaxThreadCount(MAX_PROBE_THREADS);
+    }
+
+    return pool;
+}
+
+// the mount points being probed by all the computer models, one probe for a
+// mount at a time, so a hung mount holds one thread of the pool only
+QMutex probingMountsMutex;
+QSet<QString> probingMounts;
+
+FileSystemUsage probeFileSystem(const QString &path)
+{
+    FileSystemUsage usage;
+    struct statvfs st;
+
+    if (statvfs(path.toLocal8Bit().constData(), &st) != 0) {
+        return usage;
+    }
+
+    // same as QStorageInfo::bytesTotal() - QStorageInfo::bytesFree()
+    usage.valid = true;
+    usage.total = quint64(st.f_blocks) * st.f_frsize;
+    usage.used = quint64(st.f_blocks - st.f_bfree) * st.f_frsize;
+
+    return usage;
+}
+}
+
 ComputerModel::ComputerModel(QObject *parent) :
     QAbstractItemModel(parent),
-    m_diskm(new DDiskManager(this))
+    m_diskm(new DDiskManager(this)),
+    m_probeTimer(new QTimer(this))
 {
     m_diskm->setWatchChanges(true);
     par = qobject_cast<ComputerView*>(parent);
@@ -80,19 +142,19 @@ ComputerModel::ComputerModel(QObject *parent) :
             }
     });
     connect(m_watcher, &DAbstractFileWatcher::fileAttributeChanged, [this](const DUrl &url) {
-        int p;
-        for (p = 0; p < m_items.size(); ++p) {
-            if (m_items[p].url == url) {
-                break;
-            }
-        }
-        if (p >= m_items.size()) {
+        int p = findItem(url);
+        if (p == -1) {
             return;
         }
         QModelIndex idx = index(p, 0);
         static_cast<DFMRootFileInfo*>(m_items[p].fi.data())->checkCache();
-        emit dataChanged(idx, idx, {Qt::ItemDataRole::DisplayRole});
+        emit dataChanged(idx, idx, {Qt::ItemDataRole::DisplayRole, Qt::ItemDataRole::DecorationRole});
+        probeItem(url);
     });
+
+    connect(m_probeTimer, &QTimer::timeout, this, &ComputerModel::probeAllItems);
+    m_probeTimer->setInterval(PROBE_INTERVAL);
+    m_probeTimer->start();
 }
 
 ComputerModel::~ComputerModel()
@@ -153,15 +215,16 @@ QVariant ComputerModel::data(const QModelIndex &index, int role) const
         //!!TODO: ?
     }
 
+    // the usage is probed asynchronously, never stat the device on painting
     if (role == DataRoles::SizeInUseRole) {
         if (pitmdata->fi) {
-            return pitmdata->fi->extraProperties()["fsUsed"];
+            return pitmdata->sizeInUse;
         }
     }
 
     if (role == DataRoles::SizeTotalRole) {
         if (pitmdata->fi) {
-            return pitmdata->fi->extraProperties()["fsSize"];
+            return pitmdata->sizeTotal;
         }
     }
 
@@ -256,6 +319,7 @@ void ComputerModel::addItem(const DUrl &url, QWidget* w)
     endInsertRows();
     if (url.scheme() != SPLITTER_SCHEME && url.scheme() != WIDGET_SCHEME) {
         Q_EMIT itemCountChanged(++m_nitems);
+        probeItem(url);
     }
 }
 
@@ -277,6 +341,7 @@ void ComputerModel::insertAfter(const DUrl &url, const DUrl &ref, QWidget *w)
     endInsertRows();
     if (url.scheme() != SPLITTER_SCHEME && url.scheme() != WIDGET_SCHEME) {
         Q_EMIT itemCountChanged(++m_nitems);
+        probeItem(url);
     }
 }
 
@@ -298,6 +363,7 @@ void ComputerModel::insertBefore(const DUrl &url, const DUrl &ref, QWidget *w)
     endInsertRows();
     if (url.scheme() != SPLITTER_SCHEME && url.scheme() != WIDGET_SCHEME) {
         Q_EMIT itemCountChanged(++m_nitems);
+        probeItem(url);
     }
 }
 
@@ -311,6 +377,7 @@ void ComputerModel::removeItem(const DUrl &url)
     beginRemoveRows(QModelIndex(), p, p);
     m_items.removeAt(p);
     endRemoveRows();
+    m_slowUrls.remove(url);
     if (url.scheme() != SPLITTER_SCHEME && url.scheme() != WIDGET_SCHEME) {
         Q_EMIT itemCountChanged(--m_nitems);
     }
@@ -327,6 +394,9 @@ void ComputerModel::initItemData(ComputerModelItemData &data, const DUrl &url, Q
         data.widget = w;
     } else {
         data.fi = fileService->createFileInfo(this, url);
+        if (DFMRootFileInfo *fi = dynamic_cast<DFMRootFileInfo*>(data.fi.data())) {
+            data.sizeTotal = fi->deviceSize();
+        }
         if (data.fi->suffix() == SUFFIX_USRDIR) {
             data.cat = ComputerModelItemData::Category::cat_user_directory;
         } else {
@@ -349,6 +419,93 @@ int ComputerModel::findItem(const DUrl &url)
     return p;
 }
 
+void ComputerModel::probeItem(const DUrl &url)
+{
+    int p = findItem(url);
+    if (p == -1 || !m_items[p].fi || m_items[p].fi->suffix() == SUFFIX_USRDIR) {
+        return;
+    }
+
+    DFMRootFileInfo *fi = static_cast<DFMRootFileInfo*>(m_items[p].fi.data());
+    const QString &mountPoint = fi->mountPoint();
+    if (mountPoint.isEmpty()) {
+        setItemUsage(url, ~0ULL, fi->deviceSize());
+        return;
+    }
+
+    {
+        QMutexLocker locker(&probingMountsMutex);
+
+        if (probingMounts.contains(mountPoint)) {
+            return;
+        }
+        probingMounts.insert(mountPoint);
+    }
+
+    // the usage of the udisks devices is shown against the size of the device
+    const bool useDeviceSize = fi->suffix() == SUFFIX_UDISKS;
+    const quint64 deviceSize = fi->deviceSize();
+
+    QFutureWatcher<FileSystemUsage> *watcher = new QFutureWatcher<FileSystemUsage>(this);
+
+    connect(watcher, &QFutureWatcher<FileSystemUsage>::finished, this, [this, watcher, url, useDeviceSize, deviceSize] {
+        const FileSystemUsage &usage = watcher->result();
+        if (usage.valid) {
+            m_slowUrls.remove(url);
+            setItemUsage(url, usage.used, useDeviceSize ? deviceSize : usage.total);
+        }
+
+        watcher->deleteLater();
+    });
+
+    // released by the probe itself, the model may be gone when it finishes
+    watcher->setFuture(QtConcurrent::run(probeThreadPool(), [mountPoint] {
+        const FileSystemUsage &usage = probeFileSystem(mountPoint);
+        QMutexLocker locker(&probingMountsMutex);
+
+        probingMounts.remove(mountPoint);
+
+        return usage;
+    }));
+
+    QTimer::singleShot(PROBE_TIMEOUT, watcher, [this, watcher, url, mountPoint] {
+        if (!watcher->isFinished() && !m_slowUrls.contains(url)) {
+            qWarning() << "probing" << mountPoint << "timed out, the last known usage is kept";
+            m_slowUrls.insert(url);
+        }
+    });
+}
+
+void ComputerModel::probeAllItems()
+{
+    const bool probeSlow = ++m_probeTicks % SLOW_PROBE_TICKS == 0;
+
+    for (const ComputerModelItemData &item : m_items) {
+        if (item.fi && (probeSlow || !m_slowUrls.contains(item.url))) {
+            probeItem(item.url);
+        }
+    }
+}
+
+void ComputerModel::setItemUsage(const DUrl &url, quint64 sizeInUse, quint64 sizeTotal)
+{
+    int p = findItem(url);
+    if (p == -1) {
+        return;
+    }
+
+    ComputerModelItemData &item = m_items[p];
+    if (item.sizeInUse == sizeInUse && item.sizeTotal == sizeTotal) {
+        return;
+    }
+
+    item.sizeInUse = sizeInUse;
+    item.sizeTotal = sizeTotal;
+
+    QModelIndex idx = index(p, 0);
+    emit dataChanged(idx, idx, {DataRoles::SizeInUseRole, DataRoles::SizeTotalRole});
+}
+
 DUrl ComputerModel::makeSplitterUrl(QString text)
 {
     DUrl ret;
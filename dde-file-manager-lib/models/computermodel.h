@@ -24,6 +24,7 @@
 #include "ddiskmanager.h"
 
 #include <QAbstractItemModel>
+#include <QSet>
 
 #include "durl.h"
 #include "interfaces/dabstractfileinfo.h"
@@ -32,6 +33,7 @@
 #define SPLITTER_SCHEME "splitter"
 #define WIDGET_SCHEME "widget"
 
+class QTimer;
 class ComputerView;
 
 struct ComputerModelItemData
@@ -50,6 +52,9 @@ struct ComputerModelItemData
     QWidget* widget = nullptr;
     Category cat;
     bool selected;
+    // the last known usage of the file system, the prober updates it
+    quint64 sizeInUse = ~0ULL;
+    quint64 sizeTotal = 0;
 };
 
 class ComputerModel : public QAbstractItemModel
@@ -99,10 +104,17 @@ private:
     QList<ComputerModelItemData> m_items;
     DAbstractFileWatcher* m_watcher;
     int m_nitems;
+    QTimer *m_probeTimer;
+    QSet<DUrl> m_slowUrls;
+    uint m_probeTicks = 0;
 
     void initItemData(ComputerModelItemData &data, const DUrl &url, QWidget *w);
     int findItem(const DUrl &url);
 
+    void probeItem(const DUrl &url);
+    void probeAllItems();
+    void setItemUsage(const DUrl &url, quint64 sizeInUse, quint64 sizeTotal);
+
     static DUrl makeSplitterUrl(QString text);
 };
 
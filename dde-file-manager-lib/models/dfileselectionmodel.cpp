@@ -23,9 +23,12 @@
  */
 
 #include "dfileselectionmodel.h"
+#include "dfilesystemmodel.h"
 
 #include <QDebug>
 
+#include <algorithm>
+
 DFileSelectionModel::DFileSelectionModel(QAbstractItemModel *model)
     : QItemSelectionModel(model)
 {
@@ -80,6 +83,52 @@ QModelIndexList DFileSelectionModel::selectedIndexes() const
     return m_selectedList;
 }
 
+void DFileSelectionModel::selectionStatistics(int *fileCount, int *directoryCount, qint64 *fileSize) const
+{
+    *fileCount = 0;
+    *directoryCount = 0;
+    *fileSize = 0;
+
+    const DFileSystemModel *fileModel = qobject_cast<const DFileSystemModel*>(model());
+
+    if (!fileModel) {
+        return;
+    }
+
+    const QItemSelection &ranges = m_currentCommand != QItemSelectionModel::SelectionFlags(Current|Rows|ClearAndSelect)
+            ? selection() : m_selection;
+    QList<QPair<int, int>> rows;
+
+    for (const QItemSelectionRange &range : ranges) {
+        if (range.isValid() && range.parent() == QModelIndex()) {
+            rows << qMakePair(range.top(), range.bottom());
+        }
+    }
+
+    // the ranges may overlap
+    std::sort(rows.begin(), rows.end());
+
+    int end = -1;
+
+    for (const QPair<int, int> &row : rows) {
+        const int first = qMax(row.first, end + 1);
+
+        if (first > row.second) {
+            continue;
+        }
+
+        int files, directories;
+        qint64 size;
+
+        fileModel->rowsStatistics(first, row.second, &files, &directories, &size);
+
+        *fileCount += files;
+        *directoryCount += directories;
+        *fileSize += size;
+        end = row.second;
+    }
+}
+
 void DFileSelectionModel::select(const QItemSelection &selection, QItemSelectionModel::SelectionFlags command)
 {
     if (!command.testFlag(NoUpdate))
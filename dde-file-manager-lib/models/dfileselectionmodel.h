@@ -39,6 +39,10 @@ public:
 
     QModelIndexList selectedIndexes() const;
 
+    // the selected regular files and directories and the total size of the files,
+    // summed per selected row range by DFileSystemModel::rowsStatistics
+    void selectionStatistics(int *fileCount, int *directoryCount, qint64 *fileSize) const;
+
 protected:
     void select(const QItemSelection &selection, QItemSelectionModel::SelectionFlags command) Q_DECL_OVERRIDE;
     void clear() Q_DECL_OVERRIDE;
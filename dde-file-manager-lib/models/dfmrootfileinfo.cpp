@@ -47,7 +47,7 @@ public:
     QExplicitlySharedDataPointer<DGioFileInfo> gfsi;
     QString backer_url;
     QByteArrayList mps;
-    qulonglong size;
+    qulonglong size = 0;
     QString label;
     QString fs;
     QString udispname;
@@ -488,6 +488,28 @@ void DFMRootFileInfo::checkCache()
     d->udispname = udisksDisplayName();
 }
 
+QString DFMRootFileInfo::mountPoint() const
+{
+    Q_D(const DFMRootFileInfo);
+    if (suffix() == SUFFIX_GVFSMP) {
+        return d->backer_url;
+    } else if (suffix() == SUFFIX_UDISKS && !d->mps.empty()) {
+        return QString::fromUtf8(d->mps.front());
+    }
+    return QString();
+}
+
+quint64 DFMRootFileInfo::deviceSize() const
+{
+    Q_D(const DFMRootFileInfo);
+    if (suffix() == SUFFIX_GVFSMP) {
+        return d->gfsi ? d->gfsi->fsTotalBytes() : 0;
+    } else if (suffix() == SUFFIX_UDISKS) {
+        return d->size;
+    }
+    return 0;
+}
+
 QString DFMRootFileInfo::udisksDisplayName()
 {
     Q_D(DFMRootFileInfo);
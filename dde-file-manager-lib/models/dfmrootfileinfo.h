@@ -87,6 +87,10 @@ public:
     void checkCache();
     QString udisksDisplayName();
 
+    // the cached values, these don't touch the device
+    QString mountPoint() const;
+    quint64 deviceSize() const;
+
     static bool typeCompare(const DAbstractFileInfoPointer &a, const DAbstractFileInfoPointer &b);
 private:
     QScopedPointer<DFMRootFileInfoPrivate> d_ptr;
@@ -25,6 +25,7 @@
 #include "desktopfile.h"
 #include "properties.h"
 #include <QFile>
+#include <QDataStream>
 #include <QSettings>
 #include <QDebug>
 
@@ -161,3 +162,21 @@ QStringList DesktopFile::getMimeType() const {
     return m_mimeType;
 }
 //---------------------------------------------------------------------------
+
+QDataStream &operator<<(QDataStream &stream, const DesktopFile &file)
+{
+    stream << file.m_fileName << file.m_name << file.m_genericName << file.m_localName
+           << file.m_exec << file.m_icon << file.m_type << file.m_categories << file.m_mimeType
+           << file.m_deepinId << file.m_deepinVendor << file.m_noDisplay << file.m_hidden;
+
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, DesktopFile &file)
+{
+    stream >> file.m_fileName >> file.m_name >> file.m_genericName >> file.m_localName
+           >> file.m_exec >> file.m_icon >> file.m_type >> file.m_categories >> file.m_mimeType
+           >> file.m_deepinId >> file.m_deepinVendor >> file.m_noDisplay >> file.m_hidden;
+
+    return stream;
+}
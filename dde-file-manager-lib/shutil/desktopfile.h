@@ -27,6 +27,8 @@
 
 #include <QStringList>
 
+class QDataStream;
+
 /**
  * @class DesktopFile
  * @brief Represents a linux desktop file
@@ -49,6 +51,10 @@ public:
   bool getNoShow() const;
   QStringList getCategories() const;
   QStringList getMimeType() const;
+
+  // used by the desktop file index of MimesAppsManager
+  friend QDataStream &operator<<(QDataStream &stream, const DesktopFile &file);
+  friend QDataStream &operator>>(QDataStream &stream, DesktopFile &file);
 private:
   QString m_fileName;
   QString m_name;
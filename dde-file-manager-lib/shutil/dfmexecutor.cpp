@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dfmexecutor.h"
+
+#include "interfaces/durl.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+namespace {
+// the executor of the task running in this thread
+thread_local DFMExecutor *currentExecutor = nullptr;
+}
+
+DFMExecutor *DFMExecutor::instance(Kind kind)
+{
+    // never deleted, a thread blocked by a dead network mount must not block the exit
+    static DFMExecutor *const executors[KindCount] = {
+        new DFMExecutor("Cpu", qMax(2, QThread::idealThreadCount()), 64),
+        new DFMExecutor("LocalIO", qBound(2, QThread::idealThreadCount(), 8), 256),
+        new DFMExecutor("RemoteIO", 4, 64),
+        new DFMExecutor("FileOperation", 32, 256)
+    };
+
+    return executors[kind];
+}
+
+DFMExecutor *DFMExecutor::forUrl(const DUrl &url)
+{
+    static const QStringList remoteSchemes {
+        NETWORK_SCHEME, SMB_SCHEME, AFC_SCHEME, MTP_SCHEME, DAV_SCHEME,
+        GPHOTO2_SCHEME, FTP_SCHEME, SFTP_SCHEME
+    };
+
+    if (remoteSchemes.contains(url.scheme()))
+        return instance(RemoteIO);
+
+    // the trash, recent, search, tag and the other virtual schemes are local
+    if (!url.isLocalFile())
+        return instance(LocalIO);
+
+    const QString &path = url.toLocalFile();
+
+    // the gvfs mounts, a statvfs here may block on a dead one
+    if (path.startsWith("/run/user/") && path.contains("/gvfs/"))
+        return instance(RemoteIO);
+
+    return instance(LocalIO);
+}
+
+DFMExecutor::CancelToken DFMExecutor::createCancelToken()
+{
+    return CancelToken(new QAtomicInt(0));
+}
+
+void DFMExecutor::cancel(const CancelToken &token)
+{
+    if (token)
+        token->store(1);
+}
+
+bool DFMExecutor::isCanceled(const CancelToken &token)
+{
+    return token && token->load();
+}
+
+QStringList DFMExecutor::statistics()
+{
+    QStringList list;
+
+    for (int i = 0; i < KindCount; ++i) {
+        const DFMExecutor *e = instance(static_cast<Kind>(i));
+
+        list << QString("%1 threads=%2/%3 running=%4 queued=%5 max-queued=%6/%7 submitted=%8 rejected=%9 canceled=%10")
+             .arg(e->m_name).arg(e->m_pool.activeThreadCount()).arg(e->m_pool.maxThreadCount())
+             .arg(e->m_running.load()).arg(e->m_queued.load())
+             .arg(e->m_maxQueued.load()).arg(e->m_maxQueueSize)
+             .arg(e->m_submitted.load()).arg(e->m_rejected.load()).arg(e->m_canceled.load());
+    }
+
+    return list;
+}
+
+DFMExecutor::DFMExecutor(const char *name, int maxThreadCount, int maxQueueSize)
+    : m_name(name)
+    , m_maxQueueSize(maxQueueSize)
+    , m_slots(maxQueueSize)
+{
+    m_pool.setMaxThreadCount(maxThreadCount);
+}
+
+DFMExecutor::WaitScope::WaitScope()
+    : m_executor(currentExecutor)
+{
+    if (m_executor)
+        m_executor->m_pool.releaseThread();
+}
+
+DFMExecutor::WaitScope::~WaitScope()
+{
+    if (m_executor)
+        m_executor->m_pool.reserveThread();
+}
+
+DFMExecutor::TaskScope::TaskScope(DFMExecutor *executor, bool reserved)
+    : m_executor(executor)
+    , m_lastExecutor(currentExecutor)
+{
+    currentExecutor = executor;
+    executor->m_queued.deref();
+    executor->m_running.ref();
+
+    if (reserved)
+        executor->m_slots.release();
+}
+
+DFMExecutor::TaskScope::~TaskScope()
+{
+    m_executor->m_running.deref();
+    currentExecutor = m_lastExecutor;
+}
+
+bool DFMExecutor::TaskScope::isCanceled(const CancelToken &token)
+{
+    if (!DFMExecutor::isCanceled(token))
+        return false;
+
+    m_executor->m_canceled.ref();
+
+    return true;
+}
+
+bool DFMExecutor::acquireSlot(bool wait)
+{
+    if (m_slots.tryAcquire())
+        return true;
+
+    // the gui thread and the tasks of this executor never wait, the later
+    // would wait for themselves when all the threads are doing the same
+    if (!wait || currentExecutor == this || (qApp && QThread::currentThread() == qApp->thread())) {
+        if (!wait)
+            m_rejected.ref();
+
+        return false;
+    }
+
+    m_slots.acquire();
+
+    return true;
+}
+
+void DFMExecutor::updateMaxQueued()
+{
+    const int queued = m_queued.load();
+    int max = m_maxQueued.load();
+
+    while (queued > max && !m_maxQueued.testAndSetRelaxed(max, queued))
+        max = m_maxQueued.load();
+}
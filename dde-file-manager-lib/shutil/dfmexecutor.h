@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+class DUrl;
+
+// Bounded thread pools for the kinds of the background work, so the blocking
+// I/O of a network mount never starves the sorting of a view. The queue size
+// only bounds the worker threads: when the queue of an executor is full, run()
+// blocks a submitting worker thread until there is room, but the gui thread is
+// never blocked and its tasks are queued beyond the bound. tryRun() gives up
+// instead, it's the way for the gui thread to respect the bound. A task whose
+// token is canceled before it's started is dropped. A task waiting for other
+// tasks lends its thread to its executor meanwhile, see WaitScope.
+class DFMExecutor
+{
+public:
+    enum Kind {
+        // sorting and searching the loaded models
+        Cpu,
+        // the disks of this machine
+        LocalIO,
+        // gvfs and the other network mounts
+        RemoteIO,
+        // the file operations of DFMEventDispatcher, they last as long as a copy
+        FileOperation,
+        KindCount
+    };
+
+    typedef QSharedPointer<QAtomicInt> CancelToken;
+
+    static DFMExecutor *instance(Kind kind);
+    // RemoteIO for the network schemes and the gvfs mounts, LocalIO for the
+    // others, the file system is not touched
+    static DFMExecutor *forUrl(const DUrl &url);
+
+    static CancelToken createCancelToken();
+    static void cancel(const CancelToken &token);
+    static bool isCanceled(const CancelToken &token);
+
+    // a line per executor: the threads, the queue depth and the counts of the tasks
+    static QStringList statistics();
+
+    // Held by a task while it waits for the other tasks, its executor may start
+    // one more thread meanwhile, so the tasks waiting for the tasks queued behind
+    // them can't take all the threads. Does nothing outside of the tasks.
+    class WaitScope
+    {
+    public:
+        WaitScope();
+        ~WaitScope();
+
+    private:
+        DFMExecutor *m_executor;
+    };
+
+    template<typename Function>
+    auto run(Function function, const CancelToken &token = CancelToken()) -> QFuture<decltype(function())>
+    {
+        return submit(function, token, acquireSlot(true));
+    }
+
+    // false if the queue is full
+    template<typename Function>
+    bool tryRun(Function function, const CancelToken &token = CancelToken())
+    {
+        if (!acquireSlot(false))
+            return false;
+
+        submit(function, token, true);
+
+        return true;
+    }
+
+private:
+    DFMExecutor(const char *name, int maxThreadCount, int maxQueueSize);
+
+    class TaskScope
+    {
+    public:
+        TaskScope(DFMExecutor *executor, bool reserved);
+        ~TaskScope();
+
+        bool isCanceled(const CancelToken &token);
+
+    private:
+        DFMExecutor *m_executor;
+        DFMExecutor *m_lastExecutor;
+    };
+
+    template<typename Function>
+    auto submit(Function function, const CancelToken &token, bool reserved) -> QFuture<decltype(function())>
+    {
+        typedef decltype(function()) Result;
+
+        m_queued.ref();
+        m_submitted.ref();
+        updateMaxQueued();
+
+        return QtConcurrent::run(&m_pool, [this, function, token, reserved] () -> Result {
+            TaskScope scope(this, reserved);
+
+            if (scope.isCanceled(token))
+                return Result();
+
+            return function();
+        });
+    }
+
+    // true if a place in the queue is taken, it's released when the task is started
+    bool acquireSlot(bool wait);
+    void updateMaxQueued();
+
+    const char *m_name;
+    const int m_maxQueueSize;
+    QSemaphore m_slots;
+    QThreadPool m_pool;
+
+    QAtomicInt m_queued;
+    QAtomicInt m_maxQueued;
+    QAtomicInt m_running;
+    QAtomicInt m_submitted;
+    QAtomicInt m_rejected;
+    QAtomicInt m_canceled;
+};
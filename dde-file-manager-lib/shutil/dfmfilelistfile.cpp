@@ -19,6 +19,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "dfmfilelistfile.h"
+#include "dfmhiddenfilecache.h"
 
 #include <QDir>
 #include <QFile>
@@ -216,6 +217,9 @@ bool DFMFileListFile::save() const
 #endif
 
         if (ok) {
+            // the watcher may report the change later than the next lookup
+            DFMHiddenFileCache::instance()->invalidate(d->dirPath);
+
             // If we have created the file, apply the file perms
             if (createFile) {
                 QFile::Permissions perms = fileInfo.permissions() | QFile::ReadOwner | QFile::WriteOwner
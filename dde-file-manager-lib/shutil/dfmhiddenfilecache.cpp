@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dfmhiddenfilecache.h"
+
+#include <QCache>
+#include <QFile>
+#include <QMutex>
+
+#include <sys/stat.h>
+
+// the cost of an entry is 1 + its size in KiB, most .hidden files have a few names only
+#define MAX_CACHE_COST 4096
+
+namespace {
+struct HiddenFileEntry
+{
+    dev_t device;
+    ino_t inode;
+    struct timespec mtime;
+    off_t size;
+    QSharedPointer<const QSet<QByteArray>> names;
+
+    bool isValid(const struct stat &st) const
+    {
+        return device == st.st_dev && inode == st.st_ino && size == st.st_size
+                && mtime.tv_sec == st.st_mtim.tv_sec && mtime.tv_nsec == st.st_mtim.tv_nsec;
+    }
+};
+
+QByteArray formatDirPath(const QByteArray &dirPath)
+{
+    QByteArray path = dirPath;
+
+    while (path.size() > 1 && path.endsWith('/')) {
+        path.chop(1);
+    }
+
+    return path;
+}
+}
+
+class DFMHiddenFileCachePrivate
+{
+public:
+    QMutex mutex;
+    QCache<QByteArray, HiddenFileEntry> cache;
+};
+
+bool DFMHiddenFileCache::HiddenNames::isEmpty() const
+{
+    return !names || names->isEmpty();
+}
+
+bool DFMHiddenFileCache::HiddenNames::contains(const char *name, int length) const
+{
+    return names && names->contains(QByteArray::fromRawData(name, length));
+}
+
+bool DFMHiddenFileCache::HiddenNames::contains(const QByteArray &name) const
+{
+    return names && names->contains(name);
+}
+
+bool DFMHiddenFileCache::HiddenNames::contains(const QString &name) const
+{
+    // same as DFMFileListFile, the .hidden file is utf-8
+    return names && names->contains(name.toUtf8());
+}
+
+DFMHiddenFileCache *DFMHiddenFileCache::instance()
+{
+    static DFMHiddenFileCache cache;
+
+    return &cache;
+}
+
+DFMHiddenFileCache::HiddenNames DFMHiddenFileCache::hiddenNames(const QByteArray &dirPath)
+{
+    Q_D(DFMHiddenFileCache);
+
+    HiddenNames result;
+    const QByteArray &dir_path = formatDirPath(dirPath);
+    const QByteArray &file_path = dir_path + (dir_path.endsWith('/') ? ".hidden" : "/.hidden");
+    struct stat st;
+
+    if (stat(file_path.constData(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        QMutexLocker locker(&d->mutex);
+
+        d->cache.remove(dir_path);
+
+        return result;
+    }
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (const HiddenFileEntry *entry = d->cache.object(dir_path)) {
+            if (entry->isValid(st)) {
+                result.names = entry->names;
+
+                return result;
+            }
+        }
+    }
+
+    // the file is read without holding the lock, the other threads may read it too
+    QFile file(QString::fromLocal8Bit(file_path));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+
+    const QByteArray &data = file.readAll();
+    QSet<QByteArray> *names = new QSet<QByteArray>();
+
+    for (const QByteArray &name : data.split('\n')) {
+        if (!name.isEmpty()) {
+            names->insert(name);
+        }
+    }
+
+    HiddenFileEntry *entry = new HiddenFileEntry;
+
+    // if the file is changed after stat, the entry is outdated and will be read again
+    entry->device = st.st_dev;
+    entry->inode = st.st_ino;
+    entry->mtime = st.st_mtim;
+    entry->size = st.st_size;
+    entry->names.reset(names);
+    result.names = entry->names;
+
+    QMutexLocker locker(&d->mutex);
+
+    d->cache.insert(dir_path, entry, 1 + data.size() / 1024);
+
+    return result;
+}
+
+DFMHiddenFileCache::HiddenNames DFMHiddenFileCache::hiddenNames(const QString &dirPath)
+{
+    return hiddenNames(dirPath.toLocal8Bit());
+}
+
+bool DFMHiddenFileCache::isHidden(const QString &dirPath, const QString &fileName)
+{
+    return hiddenNames(dirPath).contains(fileName);
+}
+
+void DFMHiddenFileCache::invalidate(const QString &dirPath)
+{
+    Q_D(DFMHiddenFileCache);
+
+    QMutexLocker locker(&d->mutex);
+
+    d->cache.remove(formatDirPath(dirPath.toLocal8Bit()));
+}
+
+DFMHiddenFileCache::DFMHiddenFileCache()
+    : d_ptr(new DFMHiddenFileCachePrivate)
+{
+    d_ptr->cache.setMaxCost(MAX_CACHE_COST);
+}
+
+DFMHiddenFileCache::~DFMHiddenFileCache()
+{
+
+}
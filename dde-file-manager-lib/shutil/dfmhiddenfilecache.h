@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QSet>
+#include <QSharedPointer>
+#include <QScopedPointer>
+
+// The parsed .hidden files, shared by the whole process. An entry is only
+// used while the device, the inode, the mtime and the size of the .hidden
+// file are unchanged, and it's dropped by the file watchers when the file
+// is changed. The least recently used entries are dropped first.
+// DFMFileListFile is still used to edit a .hidden file.
+class DFMHiddenFileCachePrivate;
+class DFMHiddenFileCache
+{
+public:
+    class HiddenNames
+    {
+    public:
+        bool isEmpty() const;
+
+        // the name is the raw bytes of a dirent, no conversion is needed
+        bool contains(const char *name, int length) const;
+        bool contains(const QByteArray &name) const;
+        bool contains(const QString &name) const;
+
+    private:
+        QSharedPointer<const QSet<QByteArray>> names;
+
+        friend class DFMHiddenFileCache;
+    };
+
+    static DFMHiddenFileCache *instance();
+
+    // thread safe, the .hidden file of the directory is stat'ed and only read if it's changed
+    HiddenNames hiddenNames(const QByteArray &dirPath);
+    HiddenNames hiddenNames(const QString &dirPath);
+    bool isHidden(const QString &dirPath, const QString &fileName);
+
+    void invalidate(const QString &dirPath);
+
+private:
+    DFMHiddenFileCache();
+    ~DFMHiddenFileCache();
+
+    QScopedPointer<DFMHiddenFileCachePrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(DFMHiddenFileCache)
+};
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "dfmstartuptrace.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QVector>
+#include <QDebug>
+
+#include <unistd.h>
+
+namespace {
+struct TraceEvent
+{
+    const char *name;
+    qint64 begin;
+    qint64 end;
+    bool instant;
+};
+
+struct StartupTrace
+{
+    StartupTrace()
+        : filePath(QString::fromLocal8Bit(qgetenv("DFM_STARTUP_TRACE")))
+        , enabled(!filePath.isEmpty())
+    {
+        timer.start();
+    }
+
+    QString filePath;
+    bool enabled;
+    bool finished = false;
+    QMutex mutex;
+    QElapsedTimer timer;
+    QVector<TraceEvent> events;
+    // the indexes of the open phases
+    QVector<int> stack;
+};
+
+StartupTrace *trace()
+{
+    static StartupTrace trace;
+
+    return &trace;
+}
+}
+
+bool DFMStartupTrace::isEnabled()
+{
+    return trace()->enabled;
+}
+
+void DFMStartupTrace::begin(const char *name)
+{
+    StartupTrace *t = trace();
+
+    if (!t->enabled) {
+        return;
+    }
+
+    QMutexLocker locker(&t->mutex);
+
+    if (t->finished) {
+        return;
+    }
+
+    t->stack << t->events.size();
+    t->events << TraceEvent {name, t->timer.nsecsElapsed() / 1000, -1, false};
+}
+
+void DFMStartupTrace::end()
+{
+    StartupTrace *t = trace();
+
+    if (!t->enabled) {
+        return;
+    }
+
+    QMutexLocker locker(&t->mutex);
+
+    if (t->finished || t->stack.isEmpty()) {
+        return;
+    }
+
+    TraceEvent &event = t->events[t->stack.takeLast()];
+
+    event.end = t->timer.nsecsElapsed() / 1000;
+    qDebug("startup phase \"%s\": %lld ms", event.name, (event.end - event.begin) / 1000);
+}
+
+void DFMStartupTrace::mark(const char *name)
+{
+    StartupTrace *t = trace();
+
+    if (!t->enabled) {
+        return;
+    }
+
+    QMutexLocker locker(&t->mutex);
+
+    if (t->finished) {
+        return;
+    }
+
+    const qint64 time = t->timer.nsecsElapsed() / 1000;
+
+    t->events << TraceEvent {name, time, time, true};
+    qDebug("startup mark \"%s\": %lld ms", name, time / 1000);
+}
+
+void DFMStartupTrace::finish()
+{
+    StartupTrace *t = trace();
+
+    if (!t->enabled) {
+        return;
+    }
+
+    QMutexLocker locker(&t->mutex);
+
+    if (t->finished) {
+        return;
+    }
+
+    t->finished = true;
+
+    const qint64 now = t->timer.nsecsElapsed() / 1000;
+    const qint64 pid = getpid();
+    QJsonArray events;
+
+    for (const TraceEvent &event : t->events) {
+        QJsonObject object;
+
+        object["name"] = QString::fromLatin1(event.name);
+        object["cat"] = "startup";
+        object["pid"] = pid;
+        object["tid"] = pid;
+        object["ts"] = event.begin;
+
+        if (event.instant) {
+            object["ph"] = "i";
+            object["s"] = "p";
+        } else {
+            // the phases still open end now
+            object["ph"] = "X";
+            object["dur"] = (event.end < 0 ? now : event.end) - event.begin;
+        }
+
+        events << object;
+    }
+
+    QFile file(t->filePath);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to write the startup trace:" << file.errorString();
+
+        return;
+    }
+
+    file.write(QJsonDocument(QJsonObject {{"traceEvents", events}}).toJson(QJsonDocument::Compact));
+}
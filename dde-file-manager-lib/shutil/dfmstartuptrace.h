@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtGlobal>
+
+// Records the wall time of the startup phases. Nothing is recorded unless the
+// DFM_STARTUP_TRACE environment variable is set to a file path, then the
+// phases are written to it as Chrome trace json (chrome://tracing) by finish().
+class DFMStartupTrace
+{
+public:
+    static bool isEnabled();
+
+    // the phases may be nested, the name must be a string literal
+    static void begin(const char *name);
+    static void end();
+    // an instant event, such as the first paint of a window
+    static void mark(const char *name);
+    // writes the trace file once, the later phases are dropped
+    static void finish();
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name) { begin(name); }
+        ~Scope() { end(); }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+    };
+};
@@ -485,9 +485,9 @@ DSqliteHandle *DSqliteHandle::instance()
     return theInstance;
 }
 
-void DSqliteHandle::onMountAdded(UDiskDeviceInfoPointer infoPointer)
+// a batch of mounts changed, the mount table is parsed once for all of them
+void DSqliteHandle::onMountsChanged()
 {
-    (void)infoPointer;
     m_flag.store(true, std::memory_order_release);
 
     std::lock_guard<std::mutex> raiiLock{ m_mutex };
@@ -502,23 +502,6 @@ void DSqliteHandle::onMountAdded(UDiskDeviceInfoPointer infoPointer)
     m_flag.store(false, std::memory_order_release);
 }
 
-void DSqliteHandle::onMountRemoved(UDiskDeviceInfoPointer infoPointer)
-{
-    (void)infoPointer;
-
-    m_flag.store(true, std::memory_order_release);
-    std::lock_guard<std::mutex> raiiLock{ m_mutex };
-    std::map<QString, std::multimap<QString, QString>> partionsAndMountPoints{ DSqliteHandle::queryPartionsInfoOfDevices() };
-    m_partionsOfDevices.reset(nullptr);
-
-    if (!partionsAndMountPoints.empty()) {
-        m_partionsOfDevices = std::unique_ptr<std::map<QString, std::multimap<QString, QString>>> {
-            new std::map<QString, std::multimap<QString, QString>>{ partionsAndMountPoints }
-        };
-    }
-    m_flag.store(false, std::memory_order_release);
-}
-
 
 QString DSqliteHandle::restoreEscapedChar(const QString &value)
 {
@@ -683,8 +666,7 @@ DSqliteHandle::ReturnCode DSqliteHandle::checkWhetherHasSqliteInPartion(const QS
 
 void DSqliteHandle::initializeConnect()
 {
-    QObject::connect(deviceListener, &UDiskListener::mountAdded, this, &DSqliteHandle::onMountAdded);
-    QObject::connect(deviceListener, &UDiskListener::mountRemoved, this, &DSqliteHandle::onMountRemoved);
+    QObject::connect(deviceListener, &UDiskListener::mountsChanged, this, &DSqliteHandle::onMountsChanged);
 }
 
 void DSqliteHandle::connectToSqlite(const QString &mountPoint, const QString &db_name)
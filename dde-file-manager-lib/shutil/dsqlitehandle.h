@@ -118,8 +118,7 @@ signals:
     void untagFiles(const QVariantMap& del_tags_of_file);
 
 private slots:
-    void onMountAdded(UDiskDeviceInfoPointer infoPointer);
-    void onMountRemoved(UDiskDeviceInfoPointer infoPointer);
+    void onMountsChanged();
 
 private:
     static QString restoreEscapedChar(const QString& value);
@@ -34,6 +34,9 @@
 #include "mimetypedisplaymanager.h"
 
 #include <QDir>
+#include <QDataStream>
+#include <QLocale>
+#include <QSaveFile>
 #include <QSettings>
 #include <QMimeType>
 #include <QDirIterator>
@@ -52,6 +55,8 @@
 #include "interfaces/dfileservices.h"
 #include "fileutils.h"
 
+#include <sys/stat.h>
+
 #undef signals
 extern "C" {
     #include <gio/gio.h>
@@ -62,6 +67,235 @@ extern "C" {
 
 DFM_USE_NAMESPACE
 
+#define DESKTOP_INDEX_MAGIC 0x44464d44
+#define DESKTOP_INDEX_VERSION 1
+
+namespace {
+// The parsed desktop files of the applications folders. A directory is listed
+// again only if its mtime is changed, and a desktop file is parsed again only
+// if its mtime, ctime or size is changed.
+struct DesktopIndexFile
+{
+    qint64 mtime = 0;
+    qint64 ctime = 0;
+    qint64 size = -1;
+    // the apps of a mime type are sorted by it
+    qint64 created = 0;
+    DesktopFile desktopFile;
+};
+
+struct DesktopIndexDirectory
+{
+    qint64 mtime = 0;
+    QStringList files;
+    QStringList subdirs;
+};
+
+struct DesktopIndex
+{
+    // the local names of the desktop files depend on it
+    QString locale;
+    QHash<QString, DesktopIndexDirectory> directories;
+    QHash<QString, DesktopIndexFile> files;
+};
+
+QDataStream &operator<<(QDataStream &stream, const DesktopIndexFile &file)
+{
+    return stream << file.mtime << file.ctime << file.size << file.created << file.desktopFile;
+}
+
+QDataStream &operator>>(QDataStream &stream, DesktopIndexFile &file)
+{
+    return stream >> file.mtime >> file.ctime >> file.size >> file.created >> file.desktopFile;
+}
+
+QDataStream &operator<<(QDataStream &stream, const DesktopIndexDirectory &dir)
+{
+    return stream << dir.mtime << dir.files << dir.subdirs;
+}
+
+QDataStream &operator>>(QDataStream &stream, DesktopIndexDirectory &dir)
+{
+    return stream >> dir.mtime >> dir.files >> dir.subdirs;
+}
+
+qint64 toNSecs(const struct timespec &time)
+{
+    return qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+QString joinPath(const QString &dirPath, const QString &name)
+{
+    return dirPath.endsWith('/') ? dirPath + name : dirPath + '/' + name;
+}
+
+bool loadDesktopIndex(const QString &filePath, DesktopIndex *index)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly) || file.size() <= 0) {
+        return false;
+    }
+
+    // the file is read through the mapping, no copy of it is made
+    uchar *data = file.map(0, file.size());
+
+    if (!data) {
+        return false;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(file.size())));
+    quint32 magic = 0;
+    quint32 version = 0;
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream >> magic >> version;
+
+    if (magic != DESKTOP_INDEX_MAGIC || version != DESKTOP_INDEX_VERSION) {
+        return false;
+    }
+
+    stream >> index->locale >> index->directories >> index->files;
+
+    if (stream.status() != QDataStream::Ok) {
+        *index = DesktopIndex();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool saveDesktopIndex(const QString &filePath, const DesktopIndex &index)
+{
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QSaveFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "failed to save the desktop files index:" << file.errorString();
+
+        return false;
+    }
+
+    QDataStream stream(&file);
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << quint32(DESKTOP_INDEX_MAGIC) << quint32(DESKTOP_INDEX_VERSION);
+    stream << index.locale << index.directories << index.files;
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+// Returns true if the index is changed. The desktop files in the directory
+// and its subdirectories are appended to files.
+bool updateDesktopIndexDirectory(DesktopIndex &index, const QString &dirPath, QSet<QString> &visitedDirs, QStringList &files)
+{
+    if (visitedDirs.contains(dirPath)) {
+        return false;
+    }
+
+    visitedDirs.insert(dirPath);
+
+    struct stat st;
+
+    if (stat(QFile::encodeName(dirPath).constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    bool changed = false;
+    DesktopIndexDirectory &dir = index.directories[dirPath];
+
+    if (dir.mtime != toNSecs(st.st_mtim)) {
+        const QDir qdir(dirPath);
+
+        // same as the QDirIterator used before
+        dir.mtime = toNSecs(st.st_mtim);
+        dir.files = qdir.entryList(QStringList("*.desktop"), QDir::Files | QDir::NoDotAndDotDot);
+        dir.subdirs = qdir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        changed = true;
+    }
+
+    for (const QString &name : dir.files) {
+        files << joinPath(dirPath, name);
+    }
+
+    // the reference is invalid once the subdirectories are inserted
+    const QStringList subdirs = dir.subdirs;
+
+    for (const QString &name : subdirs) {
+        if (updateDesktopIndexDirectory(index, joinPath(dirPath, name), visitedDirs, files)) {
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+bool updateDesktopIndex(DesktopIndex &index, const QStringList &folders, QStringList &files)
+{
+    bool changed = false;
+    const QString &locale = QLocale::system().name();
+
+    if (index.locale != locale) {
+        index = DesktopIndex();
+        index.locale = locale;
+        changed = true;
+    }
+
+    QSet<QString> visited_dirs;
+
+    for (const QString &folder : folders) {
+        if (updateDesktopIndexDirectory(index, folder, visited_dirs, files)) {
+            changed = true;
+        }
+    }
+
+    for (auto it = index.directories.begin(); it != index.directories.end();) {
+        if (visited_dirs.contains(it.key())) {
+            ++it;
+        } else {
+            it = index.directories.erase(it);
+            changed = true;
+        }
+    }
+
+    QHash<QString, DesktopIndexFile> index_files;
+
+    index_files.reserve(files.size());
+
+    for (const QString &filePath : files) {
+        struct stat st;
+
+        if (stat(QFile::encodeName(filePath).constData(), &st) != 0) {
+            continue;
+        }
+
+        DesktopIndexFile file = index.files.take(filePath);
+
+        if (file.mtime != toNSecs(st.st_mtim) || file.ctime != toNSecs(st.st_ctim) || file.size != st.st_size) {
+            file.mtime = toNSecs(st.st_mtim);
+            file.ctime = toNSecs(st.st_ctim);
+            file.size = st.st_size;
+            file.created = QFileInfo(filePath).created().toMSecsSinceEpoch();
+            file.desktopFile = DesktopFile(filePath);
+            changed = true;
+        }
+
+        index_files.insert(filePath, file);
+    }
+
+    // the files left are removed
+    if (!index.files.isEmpty()) {
+        changed = true;
+    }
+
+    index.files.swap(index_files);
+
+    return changed;
+}
+}
+
 QStringList MimesAppsManager::DesktopFiles = {};
 QMap<QString, QStringList> MimesAppsManager::MimeApps = {};
 QMap<QString, QStringList> MimesAppsManager::DDE_MimeTypes = {};
@@ -74,11 +308,11 @@ QMap<QString, DesktopFile> MimesAppsManager::DesktopObjs = {};
 
 MimeAppsWorker::MimeAppsWorker(QObject *parent): QObject(parent)
 {
-    m_fileSystemWatcher = new QFileSystemWatcher;
+    // a child, so it's moved to the worker thread with the worker
+    m_fileSystemWatcher = new QFileSystemWatcher(this);
     m_updateCacheTimer = new QTimer(this);
     m_updateCacheTimer->setInterval(2000);
     m_updateCacheTimer->setSingleShot(true);
-    startWatch();
     initConnect();
 }
 
@@ -251,6 +485,8 @@ MimesAppsManager::MimesAppsManager(QObject *parent): QObject(parent)
     QThread* mimeAppsThread = new QThread;
     m_mimeAppsWorker->moveToThread(mimeAppsThread);
     mimeAppsThread->start();
+    // listing the desktop files is slow, don't do it on the main thread
+    QMetaObject::invokeMethod(m_mimeAppsWorker, "startWatch", Qt::QueuedConnection);
 }
 
 MimesAppsManager::~MimesAppsManager()
@@ -583,6 +819,11 @@ QString MimesAppsManager::getDesktopIconsCacheFile()
     return QString("%1/%2").arg(DFMStandardPaths::location(DFMStandardPaths::CachePath), "DesktopIcons.json");
 }
 
+QString MimesAppsManager::getDesktopFilesIndexFile()
+{
+    return QString("%1/%2").arg(DFMStandardPaths::location(DFMStandardPaths::CachePath), "DesktopFiles.index");
+}
+
 QStringList MimesAppsManager::getDesktopFiles()
 {
       QStringList desktopFiles;
@@ -622,56 +863,57 @@ void MimesAppsManager::initMimeTypeApps()
 
     QMap<QString, QSet<QString>> mimeAppsSet;
     loadDDEMimeTypes();
-    foreach (QString desktopFolder, getApplicationsFolders()) {
-        QDirIterator it(desktopFolder, QStringList("*.desktop"),
-                        QDir::Files | QDir::NoDotAndDotDot,
-                        QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-          it.next();
-          QString filePath = it.filePath();
-          DesktopFile desktopFile(filePath);
-          DesktopFiles.append(filePath);
-          DesktopObjs.insert(filePath, desktopFile);
-          QStringList mimeTypes = desktopFile.getMimeType();
-          QString fileName = QFileInfo(filePath).fileName();
-          if (DDE_MimeTypes.contains(fileName)){
-              mimeTypes.append(DDE_MimeTypes.value(fileName));
-          }
 
-          foreach (QString mimeType, mimeTypes) {
-              if (!mimeType.isEmpty()){
-                  QSet<QString> apps;
-                  if (mimeAppsSet.contains(mimeType)){
-                      apps = mimeAppsSet.value(mimeType);
-                      apps.insert(filePath);
-                  }else{
-                      apps.insert(filePath);
-                  }
-                  mimeAppsSet.insert(mimeType, apps);
-              }
-          }
-        }
+    // only the desktop files changed since the last time are parsed
+    static DesktopIndex index;
+    static bool indexLoaded = false;
+
+    if (!indexLoaded) {
+        indexLoaded = true;
+        loadDesktopIndex(getDesktopFilesIndexFile(), &index);
     }
 
-    foreach (QString key, mimeAppsSet.keys()) {
-        QSet<QString> apps = mimeAppsSet.value(key);
-        QStringList orderApps;
-        if (apps.count() > 1){
-            QFileInfoList fileInfos;
-            foreach (QString app, apps) {
-                QFileInfo info(app);
-                fileInfos.append(info);
-            }
+    QStringList filePaths;
+
+    if (updateDesktopIndex(index, getApplicationsFolders(), filePaths)) {
+        saveDesktopIndex(getDesktopFilesIndexFile(), index);
+    }
 
-            std::sort(fileInfos.begin(), fileInfos.end(), MimesAppsManager::lessByDateTime);
+    for (const QString &filePath : filePaths) {
+        auto file = index.files.constFind(filePath);
 
-            foreach (QFileInfo info, fileInfos) {
-                orderApps.append(info.absoluteFilePath());
+        // the file could not be stat'ed when the index was updated
+        if (file == index.files.constEnd())
+            continue;
+
+        const DesktopFile &desktopFile = file->desktopFile;
+        DesktopFiles.append(filePath);
+        DesktopObjs.insert(filePath, desktopFile);
+        QStringList mimeTypes = desktopFile.getMimeType();
+        QString fileName = QFileInfo(filePath).fileName();
+        if (DDE_MimeTypes.contains(fileName)){
+            mimeTypes.append(DDE_MimeTypes.value(fileName));
+        }
+
+        foreach (const QString &mimeType, mimeTypes) {
+            if (!mimeType.isEmpty()){
+                mimeAppsSet[mimeType].insert(filePath);
             }
-        }else{
-            orderApps.append(apps.toList());
         }
-        MimeApps.insert(key, orderApps);
+    }
+
+    for (auto it = mimeAppsSet.constBegin(); it != mimeAppsSet.constEnd(); ++it) {
+        QStringList orderApps = it.value().toList();
+
+        if (orderApps.count() > 1){
+            // same order as lessByDateTime, the time is saved in the index,
+            // only the paths found in the index were added above
+            std::sort(orderApps.begin(), orderApps.end(), [] (const QString &a, const QString &b) {
+                return index.files.constFind(a)->created < index.files.constFind(b)->created;
+            });
+        }
+
+        MimeApps.insert(it.key(), orderApps);
     }
 
     //check mime apps from cache
@@ -716,6 +958,11 @@ void MimesAppsManager::initMimeTypeApps()
     const QString mimeInfoCacheRootPath = getMimeInfoCacheFileRootPath();
     foreach (QString desktop, audioDesktopList) {
         const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath,desktop);
+        auto desktopObj = DesktopObjs.constFind(path);
+        if (desktopObj != DesktopObjs.constEnd()) {
+            AudioMimeApps.insert(path, desktopObj.value());
+            continue;
+        }
         if(!QFile::exists(path))
             continue;
         DesktopFile df(path);
@@ -724,6 +971,11 @@ void MimesAppsManager::initMimeTypeApps()
 
     foreach (QString desktop, imageDeksopList) {
         const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath,desktop);
+        auto desktopObj = DesktopObjs.constFind(path);
+        if (desktopObj != DesktopObjs.constEnd()) {
+            ImageMimeApps.insert(path, desktopObj.value());
+            continue;
+        }
         if(!QFile::exists(path))
             continue;
         DesktopFile df(path);
@@ -732,6 +984,11 @@ void MimesAppsManager::initMimeTypeApps()
 
     foreach (QString desktop, textDekstopList) {
         const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath,desktop);
+        auto desktopObj = DesktopObjs.constFind(path);
+        if (desktopObj != DesktopObjs.constEnd()) {
+            TextMimeApps.insert(path, desktopObj.value());
+            continue;
+        }
         if(!QFile::exists(path))
             continue;
         DesktopFile df(path);
@@ -740,6 +997,11 @@ void MimesAppsManager::initMimeTypeApps()
 
     foreach (QString desktop, videoDesktopList) {
         const QString path = QString("%1/%2").arg(mimeInfoCacheRootPath,desktop);
+        auto desktopObj = DesktopObjs.constFind(path);
+        if (desktopObj != DesktopObjs.constEnd()) {
+            VideoMimeApps.insert(path, desktopObj.value());
+            continue;
+        }
         if(!QFile::exists(path))
             continue;
         DesktopFile df(path);
@@ -105,6 +105,7 @@ public:
     static QString getMimeInfoCacheFileRootPath();
     static QString getDesktopFilesCacheFile();
     static QString getDesktopIconsCacheFile();
+    static QString getDesktopFilesIndexFile();
     static QStringList getDesktopFiles();
     static QString getDDEMimeTypeFile();
     static QMap<QString, DesktopFile> getDesktopObjs();
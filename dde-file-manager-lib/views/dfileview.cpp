@@ -144,7 +144,9 @@ public:
     DUrlList oldSelectedUrls;
     DUrl oldCurrentUrl;
 
-    DFileView::RandeIndex visibleIndexRande;
+    /// the visible file infos and a page around them are active, see updateModelActiveIndex
+    QHash<DUrl, DAbstractFileInfoPointer> activeFileInfos;
+    QTimer *updateActiveIndexTimer;
 
     /// menu actions filter
     QSet<MenuAction> menuWhitelist;
@@ -206,6 +208,14 @@ DFileView::DFileView(QWidget *parent)
     d->updateStatusBarTimer->setSingleShot(true);
     connect(d->updateStatusBarTimer, &QTimer::timeout, this, &DFileView::updateStatusBar);
 
+    // don't update the active files for every step of scrolling
+    d->updateActiveIndexTimer = new QTimer(this);
+    d->updateActiveIndexTimer->setInterval(50);
+    d->updateActiveIndexTimer->setSingleShot(true);
+    connect(d->updateActiveIndexTimer, &QTimer::timeout, this, &DFileView::updateModelActiveIndex);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged,
+            d->updateActiveIndexTimer, static_cast<void(QTimer::*)()>(&QTimer::start));
+
     d->diskmgr = new DDiskManager(this);
     connect(d->diskmgr, &DDiskManager::opticalChanged, this, &DFileView::onDriveOpticalChanged);
     d->diskmgr->setWatchChanges(true);
@@ -1213,50 +1223,110 @@ void DFileView::updateModelActiveIndex()
 {
     Q_D(DFileView);
 
+    d->updateActiveIndexTimer->stop();
+
     const RandeIndexList randeList = visibleIndexes(QRect(QPoint(0, verticalScrollBar()->value()), QSize(size())));
 
     if (randeList.isEmpty())
         return;
 
-    const RandeIndex &rande = randeList.first();
-    DAbstractFileWatcher *fileWatcher = model()->fileWatcher();
+    const RandeIndex &visibleRande = randeList.first();
+    // a page before and after the visible files are kept active too, so the thumbnail and
+    // extended property requests are not canceled when scrolling back and forth
+    const int page = visibleRande.second - visibleRande.first + 1;
+    const int first = qMax(visibleRande.first - page, 0);
+    const int last = qMin(visibleRande.second + page, count() - 1);
+
+    QHash<DUrl, DAbstractFileInfoPointer> activeFileInfos;
+    DUrlList activatedUrls;
+    QList<QPair<DUrl, QString>> checkFiles;
+    // the files without a local path, they may be on a slow remote mount
+    QList<DAbstractFileInfoPointer> checkFileInfos;
 
-    for (int i = d->visibleIndexRande.first; i < rande.first; ++i) {
+    activeFileInfos.reserve(last - first + 1);
+
+    for (int i = first; i <= last; ++i) {
         const DAbstractFileInfoPointer &fileInfo = model()->fileInfo(model()->index(i, 0));
 
-        if (fileInfo) {
-            fileInfo->makeToInactive();
+        if (!fileInfo)
+            continue;
+
+        const DUrl &fileUrl = fileInfo->fileUrl();
+
+        activeFileInfos.insert(fileUrl, fileInfo);
+
+        if (d->activeFileInfos.remove(fileUrl) > 0)
+            continue;
+
+        fileInfo->makeToActive();
+        activatedUrls << fileUrl;
+
+        const QString &localFile = fileInfo->toLocalFile();
 
-            if (fileWatcher)
-                fileWatcher->setEnabledSubfileWatcher(fileInfo->fileUrl(), false);
+        if (localFile.isEmpty()) {
+            checkFileInfos << fileInfo;
+        } else {
+            checkFiles << qMakePair(fileUrl, localFile);
         }
     }
 
-    for (int i = rande.second; i < d->visibleIndexRande.second; ++i) {
-        const DAbstractFileInfoPointer &fileInfo = model()->fileInfo(model()->index(i, 0));
+    DUrlList inactivatedUrls;
 
-        if (fileInfo) {
-            fileInfo->makeToInactive();
-            if (fileWatcher)
-                fileWatcher->setEnabledSubfileWatcher(fileInfo->fileUrl(), false);
-        }
+    inactivatedUrls.reserve(d->activeFileInfos.size());
+
+    for (const DAbstractFileInfoPointer &fileInfo : d->activeFileInfos) {
+        fileInfo->makeToInactive();
+        inactivatedUrls << fileInfo->fileUrl();
     }
 
-    d->visibleIndexRande = rande;
+    d->activeFileInfos.swap(activeFileInfos);
 
-    for (int i = rande.first; i <= rande.second; ++i) {
-        const DAbstractFileInfoPointer &fileInfo = model()->fileInfo(model()->index(i, 0));
+    if (DAbstractFileWatcher *fileWatcher = model()->fileWatcher()) {
+        for (const DUrl &url : inactivatedUrls)
+            fileWatcher->setEnabledSubfileWatcher(url, false);
 
-        if (fileInfo) {
-            fileInfo->makeToActive();
+        for (const DUrl &url : activatedUrls)
+            fileWatcher->setEnabledSubfileWatcher(url);
+    }
 
-            if (!fileInfo->exists()) {
-                model()->removeRow(i, rootIndex());
-            } else if (fileWatcher) {
-                fileWatcher->setEnabledSubfileWatcher(fileInfo->fileUrl());
-            }
+    // the visible files may be painted before they are active, but the thumbnails are only requested for the active files
+    if (!activatedUrls.isEmpty())
+        viewport()->update();
+
+    if (checkFiles.isEmpty() && checkFileInfos.isEmpty())
+        return;
+
+    // the files deleted without notification are removed, stat them out of the gui thread
+    QFutureWatcher<DUrlList> *fw = new QFutureWatcher<DUrlList>(this);
+    const QPointer<DFileSystemModel> fileModel = model();
+
+    connect(fw, &QFutureWatcher<DUrlList>::finished, this, [fw, fileModel] {
+        fw->deleteLater();
+
+        if (!fileModel)
+            return;
+
+        for (const DUrl &url : fw->result())
+            fileModel->remove(url);
+    });
+
+    fw->setFuture(QtConcurrent::run([checkFiles, checkFileInfos] {
+        DUrlList removedUrls;
+
+        for (const QPair<DUrl, QString> &file : checkFiles) {
+            const QFileInfo info(file.second);
+
+            if (!info.exists() && !info.isSymLink())
+                removedUrls << file.first;
         }
-    }
+
+        for (const DAbstractFileInfoPointer &fileInfo : checkFileInfos) {
+            if (!fileInfo->exists())
+                removedUrls << fileInfo->fileUrl();
+        }
+
+        return removedUrls;
+    }));
 }
 
 void DFileView::handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
@@ -1290,17 +1360,22 @@ void DFileView::updateStatusBar()
     if (model()->state() != DFileSystemModel::Idle)
         return;
 
+    const DUrlList &urls = selectedUrls();
     DFMEvent event(this);
     event.setWindowId(windowId());
-    event.setData(selectedUrls());
+    event.setData(urls);
     int count = selectedIndexCount();
 
-    emit notifySelectUrlChanged(selectedUrls());
+    emit notifySelectUrlChanged(urls);
 
     if (count == 0){
         d->statusBar->itemCounted(event, this->count());
     }else{
-        d->statusBar->itemSelected(event, count);
+        int fileCount, folderCount;
+        qint64 fileSize;
+
+        static_cast<DFileSelectionModel*>(selectionModel())->selectionStatistics(&fileCount, &folderCount, &fileSize);
+        d->statusBar->itemSelected(event, count, fileCount, folderCount, fileSize);
     }
 }
 
@@ -1816,21 +1891,6 @@ void DFileView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int e
         }
     }
 
-    Q_D(DFileView);
-
-    if (start < d->visibleIndexRande.second) {
-        if (end <= d->visibleIndexRande.first) {
-            d->visibleIndexRande.first -= (end - start + 1);
-            d->visibleIndexRande.second -= (end - start + 1);
-        } else if (end <= d->visibleIndexRande.second) {
-            d->visibleIndexRande.first = start;
-            d->visibleIndexRande.second -= (end - start + 1);
-        } else {
-            d->visibleIndexRande.first = d->visibleIndexRande.second = -1;
-        }
-
-    }
-
     DListView::rowsAboutToBeRemoved(parent, start, end);
 }
 
@@ -2046,7 +2106,6 @@ void DFileView::initConnects()
     connect(model(), &DFileSystemModel::rootUrlDeleted, this, &DFileView::onRootUrlDeleted);
 
     connect(this, &DFileView::iconSizeChanged, this, &DFileView::updateHorizontalOffset, Qt::QueuedConnection);
-    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &DFileView::updateModelActiveIndex);
 
     connect(DFMApplication::instance(), &DFMApplication::iconSizeLevelChanged, this, &DFileView::setIconSizeBySizeIndex);
     connect(DFMApplication::instance(), &DFMApplication::showedHiddenFilesChanged, this, &DFileView::onShowHiddenFileChanged);
@@ -2224,6 +2283,12 @@ bool DFileView::setRootUrl(const DUrl &url)
         }
     }
 
+    // the active files belong to the old directory
+    for (const DAbstractFileInfoPointer &fileInfo : d->activeFileInfos)
+        fileInfo->makeToInactive();
+
+    d->activeFileInfos.clear();
+
     QModelIndex index = model()->setRootUrl(fileUrl);
 
     setRootIndex(index);
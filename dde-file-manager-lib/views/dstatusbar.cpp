@@ -299,6 +299,38 @@ void DStatusBar::initJobConnection()
     connect(m_fileStatisticsJob, &DFileStatisticsJob::directoryFound, this, onFoundFile);
 }
 
+void DStatusBar::prepareFileStatisticsJob()
+{
+    discardFileStatisticsJob();
+
+    if (!m_fileStatisticsJob) {
+        m_fileStatisticsJob = new DFileStatisticsJob(this);
+        m_fileStatisticsJob->setFileHints(DFileStatisticsJob::ExcludeSourceFile | DFileStatisticsJob::SingleDepth);
+        initJobConnection();
+    }
+}
+
+void DStatusBar::discardFileStatisticsJob()
+{
+    if (!m_fileStatisticsJob || !m_fileStatisticsJob->isRunning()) {
+        return;
+    }
+
+    // don't block the gui thread until the job exits, it's deleted after finished
+    DFileStatisticsJob *job = m_fileStatisticsJob;
+
+    m_fileStatisticsJob = nullptr;
+    job->disconnect(this);
+    job->stop();
+    job->setParent(nullptr);
+    connect(job, &DFileStatisticsJob::finished, job, &DFileStatisticsJob::deleteLater);
+
+    // finished before the connection
+    if (job->isFinished()) {
+        job->deleteLater();
+    }
+}
+
 void DStatusBar::itemSelected(const DFMEvent &event, int number)
 {
     if (!m_label || event.windowId() != WindowManager::getWindowId(this))
@@ -311,18 +343,7 @@ void DStatusBar::itemSelected(const DFMEvent &event, int number)
      * A fix better than the current one should eventually be applied.
      */
 
-    if (!m_fileStatisticsJob) {
-        m_fileStatisticsJob = new DFileStatisticsJob(this);
-        m_fileStatisticsJob->setFileHints(DFileStatisticsJob::ExcludeSourceFile | DFileStatisticsJob::SingleDepth);
-    } else if (m_fileStatisticsJob->isRunning()) {
-        m_fileStatisticsJob->stop();
-        m_fileStatisticsJob->wait();
-    }
-
-    if (m_isjobDisconnect) {
-        m_isjobDisconnect = false;
-        initJobConnection();
-    }
+    prepareFileStatisticsJob();
 
     m_fileCount = 0;
     m_fileSize = 0;
@@ -398,6 +419,34 @@ void DStatusBar::itemSelected(const DFMEvent &event, int number)
     }
 }
 
+void DStatusBar::itemSelected(const DFMEvent &event, int number, int fileCount, int folderCount, qint64 fileSize)
+{
+    if (!m_label || event.windowId() != WindowManager::getWindowId(this))
+        return;
+
+    const DUrl &fileUrl = event.fileUrlList().isEmpty() ? event.fileUrl() : event.fileUrlList().first();
+
+    // the sizes on gvfs are computed in background, and a single item has its own messages
+    if (number <= 1 || FileUtils::isGvfsMountFile(fileUrl.toLocalFile())) {
+        itemSelected(event, number);
+
+        return;
+    }
+
+    prepareFileStatisticsJob();
+
+    m_fileCount = fileCount;
+    m_fileSize = fileSize;
+    m_folderCount = folderCount;
+    m_folderContains = 0;
+
+    if (m_folderCount > 0) {
+        m_fileStatisticsJob->start(event.fileUrlList());
+    }
+
+    updateStatusMessage();
+}
+
 void DStatusBar::updateStatusMessage()
 {
     QString selectedFolders;
@@ -451,15 +500,7 @@ void DStatusBar::handdleComputerFileSizeFinished()
 
 void DStatusBar::itemCounted(const DFMEvent &event, int number)
 {
-    if (m_fileStatisticsJob) {
-        if (m_fileStatisticsJob->isRunning()) {
-            m_fileStatisticsJob->stop();
-            m_fileStatisticsJob->wait();
-            if (m_fileStatisticsJob->disconnect()) {
-                m_isjobDisconnect = true;
-            }
-        }
-    }
+    discardFileStatisticsJob();
 
     if (!m_label || event.windowId() != WindowManager::getWindowId(this))
         return;
@@ -112,6 +112,7 @@ signals:
 
 public slots:
     void itemSelected(const DFMEvent &event, int number);
+    void itemSelected(const DFMEvent &event, int number, int fileCount, int folderCount, qint64 fileSize);
     void updateStatusMessage();
     void handdleComputerFileSizeFinished();
     void handdleComputerFolderContainsFinished();
@@ -124,6 +125,8 @@ protected:
 private:
     void clearLayoutAndAnchors();
     void initJobConnection();
+    void prepareFileStatisticsJob();
+    void discardFileStatisticsJob();
 
     QString m_OnlyOneItemCounted;
     QString m_counted;
@@ -153,7 +156,6 @@ private:
     QLabel *m_lineEditLabel = Q_NULLPTR;
     QLabel *m_comboBoxLabel = Q_NULLPTR;
     DFileStatisticsJob *m_fileStatisticsJob = nullptr;
-    bool m_isjobDisconnect = true;
 
     Mode m_mode = Normal;
 };
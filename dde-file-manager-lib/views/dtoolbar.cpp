@@ -335,6 +335,16 @@ void DToolBar::addHistoryStack(){
     m_navStacks.append(new HistoryStack(65536));
 }
 
+void DToolBar::resetHistoryStack(const DUrl &url)
+{
+    if (!m_navStack) {
+        return;
+    }
+
+    m_navStack->clear();
+    pushUrlToHistoryStack(url);
+}
+
 void DToolBar::switchHistoryStack(const int index){
     m_navStack = m_navStacks.at(index);
     if(!m_navStack)
@@ -66,6 +66,8 @@ public:
     void initConnect();
     DFMCrumbBar *getCrumbWidget();
     void addHistoryStack();
+    // the history of the current tab only has the url then
+    void resetHistoryStack(const DUrl &url);
 
     int navStackCount() const;
     void updateBackForwardButtonsState();
@@ -162,6 +162,12 @@ int HistoryStack::currentIndex()
     return m_index;
 }
 
+void HistoryStack::clear()
+{
+    m_list.clear();
+    m_index = -1;
+}
+
 QT_BEGIN_NAMESPACE
 QDebug operator<<(QDebug beg, const HistoryStack &stack)
 {
@@ -42,6 +42,7 @@ public:
     int size();
     void removeAt(int i);
     int currentIndex();
+    void clear();
 private:
     QList<DUrl> m_list;
     int m_threshold;
@@ -24,6 +24,7 @@
 
 #include "windowmanager.h"
 #include "dfilemanagerwindow.h"
+#include "dtoolbar.h"
 #include "dabstractfilewatcher.h"
 #include "dabstractfileinfo.h"
 #include "dfileservices.h"
@@ -52,6 +53,10 @@
 #include <QWindow>
 #include <QTimer>
 #include <QProcess>
+#include <QElapsedTimer>
+
+// the replacement of a preloaded window is built after the shown window is settled
+#define PRELOAD_WINDOW_DELAY 1000
 
 DTK_USE_NAMESPACE
 
@@ -73,6 +78,26 @@ Q_DECLARE_FLAGS(NetWmStates, NetWmState)
 QHash<const QWidget*, quint64> WindowManager::m_windows;
 int WindowManager::m_count = 0;
 
+namespace {
+struct WindowOpening
+{
+    QElapsedTimer timer;
+    bool preloaded;
+};
+
+struct WindowOpenLatency
+{
+    int count = 0;
+    qint64 total = 0;
+    qint64 max = 0;
+};
+
+// the windows not exposed yet
+QHash<const QObject*, WindowOpening> openingWindows;
+// the latency of the new and the preloaded windows
+WindowOpenLatency openLatency[2];
+}
+
 WindowManager::WindowManager(QObject *parent) : QObject(parent)
 {
 #ifdef AUTO_RESTART_DEAMON
@@ -157,6 +182,21 @@ bool WindowManager::enableAutoQuit() const
 #endif
 }
 
+void WindowManager::setPreloadWindowEnabled(bool enabled)
+{
+    if (m_preloadWindowEnabled == enabled)
+        return;
+
+    m_preloadWindowEnabled = enabled;
+
+    if (enabled) {
+        QTimer::singleShot(PRELOAD_WINDOW_DELAY, this, &WindowManager::preloadWindow);
+    } else if (m_preloadWindow) {
+        m_preloadWindow->deleteLater();
+        m_preloadWindow = nullptr;
+    }
+}
+
 void WindowManager::showNewWindow(const DUrl &url, const bool& isNewWindow)
 {
     if (!isNewWindow){
@@ -175,13 +215,29 @@ void WindowManager::showNewWindow(const DUrl &url, const bool& isNewWindow)
         }
     }
 
+    WindowOpening opening;
+
+    opening.timer.start();
+
     QX11Info::setAppTime(QX11Info::appUserTime());
-    DFileManagerWindow *window = new DFileManagerWindow(url.isEmpty() ? DFMApplication::instance()->appUrlAttribute(DFMApplication::AA_UrlOfNewWindow) : url);
+    const DUrl &window_url = url.isEmpty() ? DFMApplication::instance()->appUrlAttribute(DFMApplication::AA_UrlOfNewWindow) : url;
+    DFileManagerWindow *window = takePreloadWindow(window_url);
+
+    opening.preloaded = window;
+
+    if (!window)
+        window = new DFileManagerWindow(window_url);
+
     loadWindowState(window);
     window->setAttribute(Qt::WA_DeleteOnClose);
     window->show();
 
-    qDebug() << "new window" << window->winId() << url;
+    qDebug() << "new window" << window->winId() << url << "preloaded:" << opening.preloaded
+             << "shown in" << opening.timer.elapsed() << "ms";
+
+    // the latency is measured until the window is exposed
+    openingWindows.insert(window->windowHandle(), opening);
+    window->windowHandle()->installEventFilter(this);
 
     connect(window, &DFileManagerWindow::aboutToClose,
             this, &WindowManager::onWindowClosed);
@@ -254,8 +310,13 @@ void WindowManager::reastartAppProcess()
 {
     if (m_windows.count() == 0){
         if (dialogManager->isTaskDialogEmpty()){
+            QWindowList windows = qApp->topLevelWindows();
+
+            if (m_preloadWindow)
+                windows.removeOne(m_preloadWindow->windowHandle());
+
             // 当没有顶级窗口时才允许应用自动退出
-            if (qApp->topLevelWindows().isEmpty()) {
+            if (windows.isEmpty()) {
                 qApp->quit();
             }
         }
@@ -288,6 +349,7 @@ void WindowManager::onWindowClosed()
         dialogManager->closeAllPropertyDialog();
     }
     m_windows.remove(static_cast<const QWidget*>(sender()));
+    openingWindows.remove(static_cast<QWidget*>(sender())->windowHandle());
 }
 
 void WindowManager::onLastActivedWindowClosed(quint64 winId)
@@ -304,3 +366,68 @@ void WindowManager::onLastActivedWindowClosed(quint64 winId)
 
     qApp->quit();
 }
+
+void WindowManager::preloadWindow()
+{
+    if (!m_preloadWindowEnabled || m_preloadWindow)
+        return;
+
+    QElapsedTimer timer;
+
+    timer.start();
+
+    // the view starts loading the url now, the window is only bound and shown later
+    m_preloadWindow = new DFileManagerWindow(DFMApplication::instance()->appUrlAttribute(DFMApplication::AA_UrlOfNewWindow));
+    // the native window is created too, showing it only maps it
+    m_preloadWindow->winId();
+
+    qDebug() << "preloaded a window in" << timer.elapsed() << "ms";
+}
+
+DFileManagerWindow *WindowManager::takePreloadWindow(const DUrl &url)
+{
+    // the window of a tab dragged out restores the rename bar in its constructor
+    if (!m_preloadWindow || DFileManagerWindow::flagForNewWindowFromTab.load())
+        return nullptr;
+
+    DFileManagerWindow *window = m_preloadWindow;
+
+    m_preloadWindow = nullptr;
+
+    if (window->currentUrl() != url) {
+        window->cd(url);
+        // the url the window was preloaded with is not a place the user has been to
+        window->getToolBar()->resetHistoryStack(window->currentUrl());
+    }
+
+    QTimer::singleShot(PRELOAD_WINDOW_DELAY, this, &WindowManager::preloadWindow);
+
+    return window;
+}
+
+bool WindowManager::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Expose && static_cast<QWindow*>(watched)->isExposed()) {
+        watched->removeEventFilter(this);
+
+        auto it = openingWindows.find(watched);
+
+        if (it != openingWindows.end()) {
+            const qint64 elapsed = it->timer.elapsed();
+            WindowOpenLatency &latency = openLatency[it->preloaded ? 1 : 0];
+
+            ++latency.count;
+            latency.total += elapsed;
+            latency.max = qMax(latency.max, elapsed);
+
+            qDebug() << "window opened in" << elapsed << "ms, preloaded:" << it->preloaded
+                     << "average:" << latency.total / latency.count << "ms"
+                     << "max:" << latency.max << "ms"
+                     << "count:" << latency.count;
+
+            openingWindows.erase(it);
+        }
+    }
+
+    return QObject::eventFilter(watched, event);
+}
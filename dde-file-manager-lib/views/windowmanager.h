@@ -27,6 +27,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QPointer>
 
 class DFileManagerWindow;
 class DUrl;
@@ -55,6 +56,9 @@ public:
 
     bool enableAutoQuit() const;
 
+    // keeps a hidden window for the next showNewWindow, for the daemon mode
+    void setPreloadWindowEnabled(bool enabled);
+
 signals:
     void start(const QString &src);
 
@@ -69,14 +73,22 @@ public slots:
 private slots:
     void onWindowClosed();
     void onLastActivedWindowClosed(quint64 winId);
+    void preloadWindow();
 
 protected:
     explicit WindowManager(QObject *parent = 0);
 
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
+    DFileManagerWindow *takePreloadWindow(const DUrl &url);
+
     static QHash<const QWidget*, quint64> m_windows;
     static int m_count;
 
+    bool m_preloadWindowEnabled = false;
+    QPointer<DFileManagerWindow> m_preloadWindow;
+
 #ifdef AUTO_RESTART_DEAMON
     QTimer* m_restartProcessTimer = NULL;
     bool m_enableAutoQuit = false;
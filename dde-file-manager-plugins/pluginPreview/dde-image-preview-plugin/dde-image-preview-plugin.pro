@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += widgets
+QT       += widgets concurrent
 
 TARGET = dde-image-preview-plugin
 TEMPLATE = lib
@@ -17,11 +17,13 @@ include(../../../common/common.pri)
 SOURCES += \
     imageview.cpp \
     main.cpp \
-    imagepreview.cpp
+    imagepreview.cpp \
+    imageloader.cpp
 
 HEADERS += \
     imageview.h \
-    imagepreview.h
+    imagepreview.h \
+    imageloader.h
 DISTFILES += dde-image-preview-plugin.json
 
 PLUGIN_INSTALL_DIR = $$PLUGINDIR/previews
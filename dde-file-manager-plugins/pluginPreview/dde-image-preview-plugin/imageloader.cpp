@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imageloader.h"
+
+#include <QFileInfo>
+#include <QImageReader>
+#include <QtConcurrent>
+
+// about a dozen of full screen previews
+#define IMAGE_CACHE_SIZE (64 * 1024)
+
+ImageLoader *ImageLoader::instance()
+{
+    static ImageLoader loader;
+
+    return &loader;
+}
+
+QFuture<void> ImageLoader::load(const QString &fileName, const QByteArray &format, const QSize &boundSize)
+{
+    for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+        if (it.value()->future.isFinished()) {
+            it = m_tasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const TaskPointer &old_task = m_tasks.value(fileName);
+
+    // a canceled task is never started, it's replaced by a new one
+    if (old_task && old_task->boundSize == boundSize && old_task->state.load() != Canceled) {
+        return old_task->future;
+    }
+
+    TaskPointer task(new Task);
+
+    task->fileName = fileName;
+    task->format = format;
+    task->boundSize = boundSize;
+    task->state.store(Pending);
+    task->future = QtConcurrent::run(&m_pool, this, &ImageLoader::decode, task);
+
+    m_tasks[fileName] = task;
+
+    return task->future;
+}
+
+bool ImageLoader::cachedImage(const QString &fileName, const QSize &boundSize, Image *image)
+{
+    const QDateTime &last_modified = QFileInfo(fileName).lastModified();
+
+    QMutexLocker locker(&m_cacheMutex);
+    const Image *cached = m_cache.object(fileName);
+
+    if (!cached || cached->boundSize != boundSize || cached->lastModified != last_modified) {
+        return false;
+    }
+
+    *image = *cached;
+
+    return true;
+}
+
+void ImageLoader::cancelOthers(const QString &fileName)
+{
+    for (const TaskPointer &task : m_tasks) {
+        if (task->fileName != fileName) {
+            task->state.testAndSetOrdered(Pending, Canceled);
+        }
+    }
+}
+
+ImageLoader::ImageLoader()
+{
+    // the decoding is memory bound, more threads don't help
+    m_pool.setMaxThreadCount(2);
+    m_cache.setMaxCost(IMAGE_CACHE_SIZE);
+}
+
+void ImageLoader::decode(TaskPointer task)
+{
+    if (!task->state.testAndSetOrdered(Pending, Running)) {
+        return;
+    }
+
+    QImageReader reader(task->fileName, task->format);
+
+    // the gif files are played by QMovie
+    if (reader.format() == QByteArrayLiteral("gif")) {
+        return;
+    }
+
+    Image *image = new Image;
+
+    image->sourceSize = reader.size();
+    image->boundSize = task->boundSize;
+    image->lastModified = QFileInfo(task->fileName).lastModified();
+
+    // the jpeg handler decodes at the scaled size directly, the other handlers
+    // decode the whole image and QImageReader scales it down
+    if (image->sourceSize.isValid()
+            && (image->sourceSize.width() > task->boundSize.width()
+                || image->sourceSize.height() > task->boundSize.height())) {
+        reader.setScaledSize(image->sourceSize.scaled(task->boundSize, Qt::KeepAspectRatio));
+    }
+
+    image->image = reader.read();
+
+    if (image->image.isNull()) {
+        delete image;
+
+        return;
+    }
+
+    // the handler can't tell the size without decoding
+    if (!image->sourceSize.isValid()) {
+        image->sourceSize = image->image.size();
+
+        if (image->image.width() > task->boundSize.width() || image->image.height() > task->boundSize.height()) {
+            image->image = image->image.scaled(task->boundSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+
+    QMutexLocker locker(&m_cacheMutex);
+
+    m_cache.insert(task->fileName, image, qMax(1, image->image.byteCount() / 1024));
+}
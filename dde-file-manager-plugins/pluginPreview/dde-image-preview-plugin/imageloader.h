@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+// Decodes the images on worker threads at the size they are shown, the big
+// images are never decoded at full size on the ui thread. The decoded images
+// are kept in a cache shared by all the views, so a prefetched file is shown
+// at once. load() and cancelOthers() must be called from the ui thread.
+class ImageLoader
+{
+public:
+    struct Image {
+        QImage image;
+        QSize sourceSize;
+        QSize boundSize;
+        QDateTime lastModified;
+    };
+
+    static ImageLoader *instance();
+
+    // the image is scaled down to fit boundSize, a pending or running load of
+    // the same file is reused
+    QFuture<void> load(const QString &fileName, const QByteArray &format, const QSize &boundSize);
+    bool cachedImage(const QString &fileName, const QSize &boundSize, Image *image);
+
+    // drops the loads which are not started, except the one of the file
+    void cancelOthers(const QString &fileName);
+
+private:
+    ImageLoader();
+
+    enum State {
+        Pending,
+        Running,
+        Canceled
+    };
+
+    struct Task {
+        QString fileName;
+        QByteArray format;
+        QSize boundSize;
+        QAtomicInt state;
+        QFuture<void> future;
+    };
+
+    typedef QSharedPointer<Task> TaskPointer;
+
+    void decode(TaskPointer task);
+
+    QHash<QString, TaskPointer> m_tasks;
+
+    QMutex m_cacheMutex;
+    // the cost is the size of the image in KiB
+    QCache<QString, Image> m_cache;
+
+    // destroyed first, it waits for the running tasks
+    QThreadPool m_pool;
+};
+
+#endif // IMAGELOADER_H
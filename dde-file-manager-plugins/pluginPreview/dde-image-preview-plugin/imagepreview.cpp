@@ -101,15 +101,7 @@ bool ImagePreview::setFileUrl(const DUrl &url)
     if (m_url == url)
         return true;
 
-    DUrl tmpUrl = url;
-    const DAbstractFileInfoPointer &info = DFileService::instance()->createFileInfo(this, url);
-
-    if (!info)
-        return false;
-
-    if (info->canRedirectionFileUrl()) {
-        tmpUrl = info->redirectedFileUrl();
-    }
+    const DUrl &tmpUrl = localFileUrl(url);
 
     if (!tmpUrl.isLocalFile())
         return false;
@@ -121,15 +113,18 @@ bool ImagePreview::setFileUrl(const DUrl &url)
 
     m_url = tmpUrl;
 
-    if (!m_imageView)
+    if (!m_imageView) {
         m_imageView = new ImageView(tmpUrl.toLocalFile(), format);
-    else
-        m_imageView->setFile(tmpUrl.toLocalFile(), format);
 
-    const QSize &image_size = m_imageView->sourceSize();
+        // the size of some formats is known after the image is decoded
+        connect(m_imageView, &ImageView::sourceSizeChanged, this, &ImagePreview::updateStatusBar);
+        // the preview is kept hidden by the dialog while the files of other types are shown
+        m_imageView->installEventFilter(this);
+    } else {
+        m_imageView->setFile(tmpUrl.toLocalFile(), format);
+    }
 
-    m_messageStatusBar->setText(QString("%1x%2").arg(image_size.width()).arg(image_size.height()));
-    m_messageStatusBar->adjustSize();
+    updateStatusBar();
 
     m_title = QFileInfo(tmpUrl.toLocalFile()).fileName();
 
@@ -164,4 +159,49 @@ void ImagePreview::copyFile() const
     DFMGlobal::setUrlsToClipboard({m_url}, DFMGlobal::CopyAction, data);
 }
 
+void ImagePreview::prefetch(const DUrl &url)
+{
+    if (!m_imageView)
+        return;
+
+    const DUrl &tmpUrl = localFileUrl(url);
+
+    // the format is detected by the loader, the other files are ignored there
+    if (tmpUrl.isLocalFile())
+        m_imageView->prefetch(tmpUrl.toLocalFile());
+}
+
+bool ImagePreview::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_imageView && m_messageStatusBar) {
+        if (event->type() == QEvent::Show)
+            m_messageStatusBar->show();
+        else if (event->type() == QEvent::Hide)
+            m_messageStatusBar->hide();
+    }
+
+    return DFMFilePreview::eventFilter(watched, event);
+}
+
+DUrl ImagePreview::localFileUrl(const DUrl &url) const
+{
+    const DAbstractFileInfoPointer &info = DFileService::instance()->createFileInfo(this, url);
+
+    if (!info)
+        return DUrl();
+
+    if (info->canRedirectionFileUrl())
+        return info->redirectedFileUrl();
+
+    return url;
+}
+
+void ImagePreview::updateStatusBar()
+{
+    const QSize &image_size = m_imageView->sourceSize();
+
+    m_messageStatusBar->setText(QString("%1x%2").arg(image_size.width()).arg(image_size.height()));
+    m_messageStatusBar->adjustSize();
+}
+
 DFM_END_NAMESPACE
@@ -42,8 +42,8 @@ DFM_BEGIN_NAMESPACE
 
 class ImagePreview : public DFMFilePreview
 {
-    Q_PLUGIN_METADATA(IID PreviewInterface_iid FILE "dde-image-preview-plugin.json")
-    Q_INTERFACES(PreviewInterface)
+    Q_OBJECT
+
 public:
     explicit ImagePreview(QObject *parent = 0);
     ~ImagePreview();
@@ -61,7 +61,16 @@ public:
 
     void copyFile() const override;
 
+public slots:
+    void prefetch(const DUrl &url);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
+    DUrl localFileUrl(const DUrl &url) const;
+    void updateStatusBar();
+
     DUrl m_url;
     QPointer<QLabel> m_messageStatusBar;
     QPointer<ImageView> m_imageView;
@@ -23,6 +23,8 @@
  */
 
 #include "imageview.h"
+#include "imageloader.h"
+#include "dthumbnailprovider.h"
 
 #include <QUrl>
 #include <QImageReader>
@@ -35,12 +37,18 @@
 #include <QLabel>
 #include <QDebug>
 #include <QMovie>
+#include <QFileInfo>
+
+DFM_USE_NAMESPACE
 
 #define MIN_SIZE QSize(400, 300)
 
 ImageView::ImageView(const QString &fileName, const QByteArray &format, QWidget *parent)
     : QLabel(parent)
+    , m_loadWatcher(new QFutureWatcher<void>(this))
 {
+    connect(m_loadWatcher, &QFutureWatcher<void>::finished, this, &ImageView::onImageLoaded);
+
     setFile(fileName, format);
     setMinimumSize(MIN_SIZE);
     setAlignment(Qt::AlignCenter);
@@ -48,6 +56,10 @@ ImageView::ImageView(const QString &fileName, const QByteArray &format, QWidget
 
 void ImageView::setFile(const QString &fileName, const QByteArray &format)
 {
+    m_fileName = fileName;
+    // the loads of the files the user has skipped are not needed any more
+    ImageLoader::instance()->cancelOthers(fileName);
+
     if (format == QByteArrayLiteral("gif")) {
         if (movie) {
             movie->stop(); // blumia: we need to stop it first before we load a new file
@@ -73,23 +85,89 @@ void ImageView::setFile(const QString &fileName, const QByteArray &format)
         tmpMovie->deleteLater();
     }
 
-    QImageReader reader(fileName, format);
+    const QSize &bound_size = boundSize();
+    ImageLoader::Image image;
 
-    m_sourceSize = reader.size();
+    if (ImageLoader::instance()->cachedImage(fileName, bound_size, &image)) {
+        m_sourceSize = image.sourceSize;
+        setImage(image.image);
 
-    const QSize &dsize = qApp->desktop()->size();
-    qreal device_pixel_ratio = this->devicePixelRatioF();
+        return;
+    }
 
-    QPixmap pixmap = QPixmap::fromImageReader(&reader).scaled(QSize(qMin((int)(dsize.width() * 0.7 * device_pixel_ratio), m_sourceSize.width()),
-                                                                    qMin((int)(dsize.height() * 0.8 * device_pixel_ratio), m_sourceSize.height())),
-                                                              Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    // only reads the header
+    m_sourceSize = QImageReader(fileName, format).size();
 
-    pixmap.setDevicePixelRatio(device_pixel_ratio);
+    // shows the thumbnail of the file manager until the image is decoded
+    const QString &thumbnail = DThumbnailProvider::instance()->thumbnailFilePath(QFileInfo(fileName), DThumbnailProvider::Large);
+    QImage placeholder;
 
-    setPixmap(pixmap);
+    if (m_sourceSize.isValid()) {
+        const QSize &size = m_sourceSize.width() > bound_size.width() || m_sourceSize.height() > bound_size.height()
+                ? m_sourceSize.scaled(bound_size, Qt::KeepAspectRatio) : m_sourceSize;
+
+        if (!thumbnail.isEmpty()) {
+            placeholder = QImage(thumbnail).scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+        }
+
+        // keeps the size of the view, the dialog is not resized when the image is loaded
+        if (placeholder.isNull()) {
+            placeholder = QImage(size, QImage::Format_ARGB32_Premultiplied);
+            placeholder.fill(Qt::transparent);
+        }
+    }
+
+    setImage(placeholder);
+
+    m_loadWatcher->setFuture(ImageLoader::instance()->load(fileName, format, bound_size));
 }
 
 QSize ImageView::sourceSize() const
 {
     return m_sourceSize;
 }
+
+void ImageView::prefetch(const QString &fileName)
+{
+    ImageLoader::Image image;
+
+    if (ImageLoader::instance()->cachedImage(fileName, boundSize(), &image)) {
+        return;
+    }
+
+    ImageLoader::instance()->load(fileName, QByteArray(), boundSize());
+}
+
+void ImageView::onImageLoaded()
+{
+    ImageLoader::Image image;
+
+    if (movie || !ImageLoader::instance()->cachedImage(m_fileName, boundSize(), &image)) {
+        return;
+    }
+
+    setImage(image.image);
+
+    if (image.sourceSize != m_sourceSize) {
+        m_sourceSize = image.sourceSize;
+
+        Q_EMIT sourceSizeChanged(m_sourceSize);
+    }
+}
+
+void ImageView::setImage(const QImage &image)
+{
+    QPixmap pixmap = QPixmap::fromImage(image);
+
+    pixmap.setDevicePixelRatio(devicePixelRatioF());
+
+    setPixmap(pixmap);
+}
+
+QSize ImageView::boundSize() const
+{
+    const QSize &dsize = qApp->desktop()->size();
+    qreal device_pixel_ratio = this->devicePixelRatioF();
+
+    return QSize((int)(dsize.width() * 0.7 * device_pixel_ratio), (int)(dsize.height() * 0.8 * device_pixel_ratio));
+}
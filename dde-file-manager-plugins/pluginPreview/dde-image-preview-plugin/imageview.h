@@ -26,6 +26,7 @@
 #define IMAGEVIEW_H
 
 #include <QLabel>
+#include <QFutureWatcher>
 
 class ImageView : public QLabel
 {
@@ -36,9 +37,21 @@ public:
     void setFile(const QString &fileName, const QByteArray &format);
     QSize sourceSize() const;
 
+    // decodes the file in background, it's shown at once when it's set to the view
+    void prefetch(const QString &fileName);
+
+signals:
+    void sourceSizeChanged(const QSize &size);
+
 private:
+    void onImageLoaded();
+    void setImage(const QImage &image);
+    QSize boundSize() const;
+
+    QString m_fileName;
     QSize m_sourceSize;
     QMovie *movie = nullptr;
+    QFutureWatcher<void> *m_loadWatcher;
 };
 
 #endif // IMAGEVIEW_H
@@ -18,11 +18,13 @@ include(../../../common/common.pri)
 SOURCES += \
     pdfwidget.cpp \
     main.cpp \
-    pdfpreview.cpp
+    pdfpreview.cpp \
+    pdfrenderscheduler.cpp
 
 HEADERS += \
     pdfwidget.h \
-    pdfpreview.h
+    pdfpreview.h \
+    pdfrenderscheduler.h
 DISTFILES += dde-pdf-preview-plugin.json
 
 PLUGIN_INSTALL_DIR = $$PLUGINDIR/previews
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pdfrenderscheduler.h"
+
+#include "poppler-document.h"
+#include "poppler-page.h"
+#include "poppler-page-renderer.h"
+
+#include <QDebug>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <algorithm>
+
+// the pages bigger than this are rendered at a lower resolution
+#define MAX_PAGE_PIXELS (1920 * 1080 * 3)
+
+PdfRenderScheduler::PdfRenderScheduler(QSharedPointer<poppler::document> doc, QObject *parent)
+    : QObject(parent)
+    , m_doc(doc)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+PdfRenderScheduler::~PdfRenderScheduler()
+{
+    m_mutex.lock();
+    m_stopped = true;
+    m_jobs.clear();
+    m_mutex.unlock();
+
+    // poppler can't be interrupted, wait for the page being rendered
+    m_pool.waitForDone();
+}
+
+void PdfRenderScheduler::schedule(Kind kind, const QList<int> &visible, const QList<int> &prefetch, int width)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_stopped) {
+        return;
+    }
+
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (it->kind == kind) {
+            it = m_jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (int index : visible) {
+        m_jobs << Job{kind, index, width, true};
+    }
+
+    for (int index : prefetch) {
+        m_jobs << Job{kind, index, width, false};
+    }
+
+    std::stable_sort(m_jobs.begin(), m_jobs.end(), [] (const Job &a, const Job &b) {
+        if (a.visible != b.visible) {
+            return a.visible;
+        }
+
+        return a.kind < b.kind;
+    });
+
+    if (!m_running && !m_jobs.isEmpty()) {
+        m_running = true;
+        QtConcurrent::run(&m_pool, this, &PdfRenderScheduler::renderJobs);
+    }
+}
+
+void PdfRenderScheduler::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_jobs.clear();
+}
+
+void PdfRenderScheduler::renderJobs()
+{
+    forever {
+        Job job;
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            if (m_stopped || m_jobs.isEmpty()) {
+                m_running = false;
+
+                return;
+            }
+
+            job = m_jobs.takeFirst();
+        }
+
+        const QImage &img = renderPage(job.index, job.width);
+
+        if (!img.isNull()) {
+            emit rendered(job.kind, job.index, job.width, img);
+        }
+    }
+}
+
+QImage PdfRenderScheduler::renderPage(int index, int width) const
+{
+    QImage img;
+
+    QScopedPointer<poppler::page> page(m_doc->create_page(index));
+
+    if (!page) {
+        return img;
+    }
+
+    poppler::page_renderer pr;
+    pr.set_render_hint(poppler::page_renderer::antialiasing, true);
+    pr.set_render_hint(poppler::page_renderer::text_antialiasing, true);
+
+    if (!pr.can_render()) {
+        qDebug () << "Cannot render page";
+        return img;
+    }
+
+    const poppler::rectf &rect = page->page_rect();
+
+    if (rect.width() <= 0 || rect.height() <= 0 || width <= 0) {
+        return img;
+    }
+
+    qreal scale = width / rect.width();
+
+    if (rect.width() * rect.height() * scale * scale > MAX_PAGE_PIXELS) {
+        scale = qSqrt(MAX_PAGE_PIXELS / (rect.width() * rect.height()));
+    }
+
+    // the page rect is in points, render at the resolution of the target size
+    // instead of scaling down a 72 dpi image
+    const poppler::image &imageData = pr.render_page(page.data(), 72 * scale, 72 * scale);
+
+    if (!imageData.is_valid()) {
+        qDebug () << "Render error";
+        return img;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(imageData.const_data());
+
+    // the data of poppler::image is released with it, copy the pixels
+    switch (imageData.format()) {
+    case poppler::image::format_invalid:
+        qDebug ()  << "Image format is invalid";
+        return img;
+    case poppler::image::format_mono:
+        img = QImage(data, imageData.width(), imageData.height(), imageData.bytes_per_row(), QImage::Format_Mono).copy();
+        break;
+    case poppler::image::format_rgb24:
+        img = QImage(data, imageData.width(), imageData.height(), imageData.bytes_per_row(), QImage::Format_RGB888).copy();
+        break;
+    case poppler::image::format_argb32:
+        img = QImage(data, imageData.width(), imageData.height(), imageData.bytes_per_row(), QImage::Format_ARGB32).copy();
+        break;
+    default:
+        break;
+    }
+
+    return img;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDFRENDERSCHEDULER_H
+#define PDFRENDERSCHEDULER_H
+
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+namespace poppler {
+class document;
+}
+
+// Renders the pages of a document on one thread, poppler documents can't be
+// used by several threads at the same time. The pending jobs are replaced on
+// each schedule() call, so the pages scrolled out of the view are never rendered.
+class PdfRenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind {
+        Page,
+        Thumb
+    };
+
+    explicit PdfRenderScheduler(QSharedPointer<poppler::document> doc, QObject *parent = 0);
+    ~PdfRenderScheduler();
+
+    // replaces the pending jobs of the kind, the visible pages are rendered before
+    // the prefetched pages of both kinds. width is the width of the image in pixels.
+    void schedule(Kind kind, const QList<int> &visible, const QList<int> &prefetch, int width);
+    void cancel();
+
+signals:
+    void rendered(int kind, int index, int width, const QImage &img);
+
+private:
+    struct Job {
+        Kind kind;
+        int index;
+        int width;
+        bool visible;
+    };
+
+    void renderJobs();
+    QImage renderPage(int index, int width) const;
+
+    QMutex m_mutex;
+    QList<Job> m_jobs;
+    bool m_running = false;
+    bool m_stopped = false;
+
+    QThreadPool m_pool;
+    QSharedPointer<poppler::document> m_doc;
+};
+
+#endif // PDFRENDERSCHEDULER_H
@@ -23,38 +23,114 @@
  */
 
 #include "pdfwidget.h"
+#include "pdfrenderscheduler.h"
 
 #include <QImage>
 #include <QHBoxLayout>
 #include <QDebug>
 #include <QApplication>
 #include <QDesktopWidget>
-#include <QtMath>
-#include <QUrl>
 #include <QLabel>
-#include <QListWidgetItem>
-#include <QThread>
-#include <QtConcurrent>
 #include <QScrollBar>
 #include <QResizeEvent>
 #include <QColor>
 #include <QPainter>
 #include <QPen>
 #include <QTimer>
-#include <QButtonGroup>
-#include <QPushButton>
+#include <QCache>
+#include <QStyledItemDelegate>
+
+namespace {
+quint64 cacheKey(int kind, int index, int width)
+{
+    return (quint64(kind) << 48) | (quint64(width) << 32) | quint32(index);
+}
+
+// paints the pages from the cache of PdfWidget, a white placeholder if the
+// page is not rendered yet
+class PdfItemDelegate : public QStyledItemDelegate
+{
+public:
+    PdfItemDelegate(PdfWidget *widget, int kind, QListView *view)
+        : QStyledItemDelegate(view)
+        , m_widget(widget)
+        , m_view(view)
+        , m_kind(kind)
+    {
+
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE
+    {
+        Q_UNUSED(option)
+
+        const qreal aspect = index.data(PdfPageModel::AspectRole).toReal();
+
+        if (m_kind == PdfRenderScheduler::Thumb) {
+            return QSizeF(DEFAULT_THUMB_SIZE.width(), DEFAULT_THUMB_SIZE.width() * aspect)
+                    .scaled(DEFAULT_THUMB_SIZE, Qt::KeepAspectRatio).toSize();
+        }
+
+        const int width = m_view->viewport()->width();
+
+        return QSize(width, qRound(width * aspect) + 4);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE
+    {
+        const QRect rect(option.rect.topLeft(), sizeHint(option, index));
+
+        painter->save();
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+        painter->fillRect(rect, Qt::white);
+
+        if (m_kind == PdfRenderScheduler::Thumb) {
+            const QImage &img = m_widget->thumbImage(index.row(), -1);
+
+            if (!img.isNull()) {
+                painter->drawImage(rect, img);
+            }
+
+            if (option.state & QStyle::State_Selected) {
+                painter->setPen(QPen(QColor("#2ca7f8"), 2));
+                painter->drawRect(rect.adjusted(1, 1, -1, -1));
+            } else {
+                painter->setPen(QColor(0, 0, 0, 51));
+                painter->drawRect(rect.adjusted(0, 0, -1, -1));
+            }
+        } else {
+            const QImage &img = m_widget->pageImage(index.row(), -1);
+
+            if (!img.isNull()) {
+                painter->drawImage(rect.adjusted(0, 2, 0, -2), img);
+            }
+
+            if (index.row() < index.model()->rowCount() - 1) {
+                painter->setPen(QColor(0, 0, 0 , 20));
+                painter->drawLine(rect.left(), rect.bottom(), rect.right(), rect.bottom());
+            }
+        }
+
+        painter->restore();
+    }
+
+private:
+    PdfWidget *m_widget;
+    QListView *m_view;
+    int m_kind;
+};
+}
 
 class PdfWidgetPrivate{
 public:
     PdfWidgetPrivate(PdfWidget* qq):
         q_ptr(qq){}
 
-    DListWidget* thumbListWidget = NULL;
-    DListWidget* pageListWidget = NULL;
+    DListView* thumbListView = NULL;
+    DListView* pageListView = NULL;
     QHBoxLayout* mainLayout = NULL;
     QScrollBar* thumbScrollBar = NULL;
     QScrollBar* pageScrollBar = NULL;
-    QButtonGroup* thumbButtonGroup = NULL;
 
     QTimer* pageWorkTimer = NULL;
     QTimer* thumbWorkTimer = NULL;
@@ -62,8 +138,10 @@ public:
 
     QSharedPointer<poppler::document> doc;
 
-    PdfInitWorker* pdfInitWorker = NULL;
-    QMap<int, QImage> pageMap;
+    PdfPageModel* pageModel = NULL;
+    PdfRenderScheduler* renderScheduler = NULL;
+    // the cost is the size of the image in KiB, the least recently painted pages are dropped
+    QCache<quint64, QImage> imageCache;
 
     PdfWidget* q_ptr = NULL;
     Q_DECLARE_PUBLIC(PdfWidget)
@@ -82,8 +160,7 @@ PdfWidget::PdfWidget(const QString &file, QWidget *parent) :
     d->thumbWorkTimer->setSingleShot(true);
     d->thumbWorkTimer->setInterval(100);
 
-    d->thumbButtonGroup = new QButtonGroup(this);
-
+    d->imageCache.setMaxCost(PAGE_CACHE_SIZE);
 
     initDoc(file);
     initUI();
@@ -99,9 +176,11 @@ PdfWidget::~PdfWidget()
 {
     Q_D(PdfWidget);
 
-    disconnect(d->pdfInitWorker, &PdfInitWorker::thumbAdded, this, &PdfWidget::onThumbAdded);
-    disconnect(d->pdfInitWorker, &PdfInitWorker::pageAdded, this, &PdfWidget::onpageAdded);
-
+    if (d->renderScheduler) {
+        disconnect(d->renderScheduler, &PdfRenderScheduler::rendered, this, &PdfWidget::onPageRendered);
+        // waits for the page being rendered
+        delete d->renderScheduler;
+    }
 }
 
 void PdfWidget::initDoc(const QString& file)
@@ -112,9 +191,11 @@ void PdfWidget::initDoc(const QString& file)
     if (!d->doc || d->doc->is_locked()) {
         qDebug () << "Cannot read this pdf file: " << file;
         d->isBadDoc = true;
+
+        return;
     }
 
-    d->pdfInitWorker = new PdfInitWorker(d->doc);
+    d->renderScheduler = new PdfRenderScheduler(d->doc);
 }
 
 void PdfWidget::initUI()
@@ -130,61 +211,71 @@ void PdfWidget::initUI()
     setFixedSize(qMin(DEFAULT_VIEW_SIZE.width(), (int)(qApp->desktop()->width() * 0.8)),
                  qMin(DEFAULT_VIEW_SIZE.height(), (int)(qApp->desktop()->height() * 0.8)));
 
-    d->thumbListWidget = new DListWidget(this);
-    d->thumbListWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    d->thumbListWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    d->thumbScrollBar = d->thumbListWidget->verticalScrollBar();
+    d->pageModel = new PdfPageModel(d->doc->pages(), this);
+
+    d->thumbListView = new DListView(this);
+    d->thumbListView->setModel(d->pageModel);
+    d->thumbListView->setItemDelegate(new PdfItemDelegate(this, PdfRenderScheduler::Thumb, d->thumbListView));
+    d->thumbListView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    d->thumbListView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    d->thumbScrollBar = d->thumbListView->verticalScrollBar();
     d->thumbScrollBar->setParent(this);
-    d->thumbListWidget->setFixedWidth(96);
-    d->thumbListWidget->setVerticalScrollMode(QListWidget::ScrollPerPixel);
-    d->thumbListWidget->setAttribute(Qt::WA_MouseTracking);
-    d->thumbListWidget->setStyleSheet("QListWidget{"
+    d->thumbListView->setFixedWidth(96);
+    d->thumbListView->setVerticalScrollMode(QListView::ScrollPerPixel);
+    d->thumbListView->setAttribute(Qt::WA_MouseTracking);
+    d->thumbListView->setStyleSheet("QListView{"
                                         "border: none;"
                                         "background: white;"
                                         "border-right: 1px solid rgba(0, 0, 0, 0.1);"
                                       "}"
-                                      "QListWidget::item{"
+                                      "QListView::item{"
                                         "border: none;"
                                       "}");
 
-    d->thumbListWidget->setSpacing(18);
+    d->thumbListView->setSpacing(18);
 
-    d->pageListWidget = new DListWidget(this);
-    d->pageListWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    d->pageListWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    d->pageListWidget->setVerticalScrollMode(QListWidget::ScrollPerPixel);
-    d->pageListWidget->setStyleSheet("QListWidget::item:selected{"
-                                        "background: white;"
-                                     "}");
-    d->pageScrollBar = d->pageListWidget->verticalScrollBar();
+    d->pageListView = new DListView(this);
+    d->pageListView->setModel(d->pageModel);
+    d->pageListView->setItemDelegate(new PdfItemDelegate(this, PdfRenderScheduler::Page, d->pageListView));
+    d->pageListView->setSelectionMode(QListView::NoSelection);
+    d->pageListView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    d->pageListView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    d->pageListView->setVerticalScrollMode(QListView::ScrollPerPixel);
+    d->pageScrollBar = d->pageListView->verticalScrollBar();
     d->pageScrollBar->setParent(this);
 
     d->mainLayout = new QHBoxLayout;
     d->mainLayout->setContentsMargins(0, 0, 0, 0);
     d->mainLayout->setSpacing(0);
-    d->mainLayout->addWidget(d->thumbListWidget);
-    d->mainLayout->addWidget(d->pageListWidget);
+    d->mainLayout->addWidget(d->thumbListView);
+    d->mainLayout->addWidget(d->pageListView);
 
     setLayout(d->mainLayout);
 
-    initEmptyPages();
-
-    loadThumbSync(0);
-    loadPageSync(0);
+    d->thumbListView->setCurrentIndex(d->pageModel->index(0));
 }
 
 void PdfWidget::initConnections()
 {
     Q_D(PdfWidget);
 
-    connect(d->pdfInitWorker, &PdfInitWorker::thumbAdded, this, &PdfWidget::onThumbAdded);
-    connect(d->pdfInitWorker, &PdfInitWorker::pageAdded, this, &PdfWidget::onpageAdded);
+    connect(d->renderScheduler, &PdfRenderScheduler::rendered, this, &PdfWidget::onPageRendered);
 
     connect(d->thumbScrollBar, &QScrollBar::valueChanged, this, &PdfWidget::onThumbScrollBarValueChanged);
     connect(d->pageScrollBar, &QScrollBar::valueChanged, this, &PdfWidget::onPageScrollBarvalueChanged);
+    connect(d->thumbScrollBar, &QScrollBar::rangeChanged, this, &PdfWidget::updateScrollBarVisible);
+    connect(d->pageScrollBar, &QScrollBar::rangeChanged, this, &PdfWidget::updateScrollBarVisible);
+    connect(d->thumbListView, &DListView::clicked, this, &PdfWidget::onThumbClicked);
+
+    // the size of the items is changed when the first page is rendered
+    connect(d->pageModel, &PdfPageModel::layoutChanged, d->pageWorkTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(d->pageModel, &PdfPageModel::layoutChanged, d->thumbWorkTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 
     connect(d->pageWorkTimer, &QTimer::timeout, this, &PdfWidget::startLoadCurrentPages);
     connect(d->thumbWorkTimer, &QTimer::timeout, this, &PdfWidget::startLoadCurrentThumbs);
+
+    d->pageWorkTimer->start();
+    d->thumbWorkTimer->start();
 }
 
 void PdfWidget::showBadPage()
@@ -202,82 +293,37 @@ void PdfWidget::showBadPage()
     setLayout(layout);
 }
 
-void PdfWidget::onThumbAdded(int index, QImage img)
+QImage PdfWidget::pageImage(int index, int width) const
 {
-    Q_D(PdfWidget);
-    QListWidgetItem* item = d->thumbListWidget->item(index);
-    QWidget* w = d->thumbListWidget->itemWidget(item);
-
-    if(!w){
-        QPushButton* bnt = new QPushButton(this);
-        d->thumbButtonGroup->addButton(bnt);
-        bnt->setIcon(QIcon(QPixmap::fromImage(img)));
-        bnt->setFixedSize(img.size());
-        bnt->setIconSize(QSize(img.width() - 4, img.height()));
-        bnt->setCheckable(true);
-        bnt->setStyleSheet("QPushButton{"
-                            "border: 1px solid rgba(0, 0, 0, 0.2);"
-                           "}"
-                           "QPushButton:checked{"
-                            "border: 2px solid #2ca7f8;"
-                           "}");
-
-        if(index == 0){
-            bnt->setChecked(true);
-        }
+    Q_D(const PdfWidget);
 
-        connect(bnt, &QPushButton::clicked, [=]{
-            bnt->setChecked(true);
-            int row = d->thumbListWidget->row(item);
-            d->pageListWidget->setCurrentRow(row);
+    const QImage *img = d->imageCache.object(cacheKey(PdfRenderScheduler::Page, index, width < 0 ? pageImageWidth() : width));
 
-        });
+    return img ? *img : QImage();
+}
 
-        d->thumbListWidget->setItemWidget(item, bnt);
-        item->setSizeHint(img.size());
-    }
+QImage PdfWidget::thumbImage(int index, int width) const
+{
+    Q_D(const PdfWidget);
 
-    if(d->thumbScrollBar->maximum() == 0){
-        d->thumbScrollBar->hide();
-    } else {
-        d->thumbScrollBar->show();
-    }
+    const QImage *img = d->imageCache.object(cacheKey(PdfRenderScheduler::Thumb, index, width < 0 ? thumbImageWidth() : width));
+
+    return img ? *img : QImage();
 }
 
-void PdfWidget::onpageAdded(int index, QImage img)
+void PdfWidget::onPageRendered(int kind, int index, int width, const QImage &img)
 {
     Q_D(PdfWidget);
 
-    d->pageMap.insert(index, img);
-
-    QListWidgetItem* item = d->pageListWidget->item(index);
-    QWidget* w = d->pageListWidget->itemWidget(item);
-
-    if(!w){
-        img = img.scaled(d->pageListWidget->width(), img.height(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QImage page(d->pageListWidget->width(), img.height() + 4, QImage::Format_ARGB32_Premultiplied);
-        page.fill(Qt::white);
-        QPainter p(&page);
-        p.drawImage((page.width() - img.width())/2, 2, img);
-        if(index < (d->doc->pages() - 1)){
-            QPen pen(QColor(0, 0, 0 , 20));
-            p.setPen(pen);
-            p.drawLine(0, page.height() - 1, page.width(), page.height() - 1);
-        }
+    QImage *image = new QImage(img);
 
-        QLabel* pageLabel = new QLabel(this);
-        pageLabel->setPixmap(QPixmap::fromImage(page));
+    image->setDevicePixelRatio(devicePixelRatioF());
+    d->imageCache.insert(cacheKey(kind, index, width), image, qMax(1, img.byteCount() / 1024));
+    d->pageModel->setAspect(index, qreal(img.height()) / img.width());
 
-        d->pageListWidget->setItemWidget(item, pageLabel);
-        item->setSizeHint(page.size());
-    }
-
-    if(d->pageScrollBar->maximum() == 0){
-        d->pageScrollBar->hide();
-    } else {
-        d->pageScrollBar->show();
-    }
+    DListView *view = kind == PdfRenderScheduler::Page ? d->pageListView : d->thumbListView;
 
+    view->update(d->pageModel->index(index));
 }
 
 void PdfWidget::onThumbScrollBarValueChanged(const int &val)
@@ -297,57 +343,30 @@ void PdfWidget::onPageScrollBarvalueChanged(const int &val)
     d->pageWorkTimer->stop();
     d->pageWorkTimer->start();
 
-    resizeCurrentPage();
+    const QModelIndex &index = d->pageListView->indexAt(QPoint(d->pageListView->width() / 2, 20));
 
-    QListWidgetItem* item = d->pageListWidget->itemAt(d->pageListWidget->width() /2 , 20);
-    if(!item){
+    if (!index.isValid()) {
         return;
     }
 
-    int row = d->pageListWidget->row(item);
-    d->thumbListWidget->setCurrentRow(row);
-    QListWidgetItem* thumbItem = d->thumbListWidget->item(row);
-    if(!thumbItem){
-        return;
-    }
+    d->thumbListView->setCurrentIndex(index);
+}
 
-    QWidget* w = d->thumbListWidget->itemWidget(thumbItem);
-    if(!w){
-        return;
-    }
+void PdfWidget::onThumbClicked(const QModelIndex &index)
+{
+    Q_D(const PdfWidget);
 
-    QPushButton* bnt = qobject_cast<QPushButton*>(w);
-    bnt->setChecked(true);
+    d->pageListView->scrollTo(index, QListView::PositionAtTop);
 }
 
 void PdfWidget::startLoadCurrentPages()
 {
-    Q_D(const PdfWidget);
-    QListWidgetItem* item = d->pageListWidget->itemAt(d->pageListWidget->width() / 2, 0);
-    if(!item){
-        item = d->pageListWidget->itemAt(d->pageListWidget->width() / 2, d->pageListWidget->spacing() * 2 + 1);
-    }
-    if(item)
-    {
-        int row = d->pageListWidget->row(item);
-        loadPageSync(row);
-    }
+    scheduleRender(PdfRenderScheduler::Page);
 }
 
 void PdfWidget::startLoadCurrentThumbs()
 {
-    Q_D(const PdfWidget);
-    QListWidgetItem* item = d->thumbListWidget->itemAt(d->thumbListWidget->width() / 2, 0);
-    //To prevent this point is int empty area, we get another point again with next pixcel that lager than it spacing
-    if(!item){
-        item = d->thumbListWidget->itemAt(d->thumbListWidget->width() / 2, d->thumbListWidget->spacing() * 2  + 1);
-    }
-
-    if(item)
-    {
-        int row = d->thumbListWidget->row(item);
-        loadThumbSync(row);
-    }
+    scheduleRender(PdfRenderScheduler::Thumb);
 }
 
 void PdfWidget::resizeEvent(QResizeEvent *event)
@@ -360,288 +379,173 @@ void PdfWidget::resizeEvent(QResizeEvent *event)
         return;
     }
 
-    if(d->pageScrollBar->maximum() == 0){
-        d->pageScrollBar->hide();
-    } else {
-        d->pageScrollBar->show();
-    }
-
-    if(d->thumbScrollBar->maximum() == 0){
-        d->thumbScrollBar->hide();
-    } else {
-        d->thumbScrollBar->show();
-    }
+    updateScrollBarVisible();
 
     d->thumbScrollBar->setFixedSize(d->thumbScrollBar->sizeHint().width(), event->size().height() - 10);
-    d->thumbScrollBar->move(d->thumbListWidget->width() - d->thumbScrollBar->width(), 10);
+    d->thumbScrollBar->move(d->thumbListView->width() - d->thumbScrollBar->width(), 10);
 
     d->pageScrollBar->setFixedSize(d->pageScrollBar->sizeHint().width(), event->size().height() - 30);
     d->pageScrollBar->move(event->size().width() - d->pageScrollBar->width(), 30);
-    d->pageListWidget->setFixedWidth(width() - d->thumbListWidget->width());
-
-    resizeCurrentPage();
-}
-
-void PdfWidget::renderBorder(QImage &img)
-{
-    QColor color(0, 0, 0, 30);
-
-    QPainter painter(&img);
-    QPen pen;
-    pen.setColor(color);
-    pen.setWidth(1);
-    painter.setPen(pen);
+    d->pageListView->setFixedWidth(width() - d->thumbListView->width());
 
-    painter.drawRect(0, 0, img.width() - 1, img.height() -1);
-}
-
-void PdfWidget::emptyBorder(QImage &img)
-{
-    QColor color(255, 255, 255);
-
-    QPainter painter(&img);
-    QPen pen;
-    pen.setColor(color);
-    pen.setWidth(2);
-    painter.setPen(pen);
-
-    painter.drawRect(0, 0, img.width() - 2, img.height() - 2);
+    // the pages are rendered at the width of the view
+    d->pageWorkTimer->start();
 }
 
-void PdfWidget::loadPageSync(const int &index)
+void PdfWidget::updateScrollBarVisible()
 {
     Q_D(PdfWidget);
 
-    QtConcurrent::run([=]{
-       d->pdfInitWorker->startGetPageImage(index);
-    });
+    d->pageScrollBar->setVisible(d->pageScrollBar->maximum() > 0);
+    d->thumbScrollBar->setVisible(d->thumbScrollBar->maximum() > 0);
 }
 
-void PdfWidget::loadThumbSync(const int &index)
+void PdfWidget::scheduleRender(int kind)
 {
     Q_D(PdfWidget);
 
-    QtConcurrent::run([=]{
-        d->pdfInitWorker->startGetPageThumb(index);
-    });
-}
+    DListView *view = kind == PdfRenderScheduler::Page ? d->pageListView : d->thumbListView;
+    const int width = kind == PdfRenderScheduler::Page ? pageImageWidth() : thumbImageWidth();
+    const int prefetchCount = kind == PdfRenderScheduler::Page ? PREFETCH_PAGE_NUM : PREFETCH_THUMB_NUM;
+    const QRect &rect = view->viewport()->rect();
+    int first = -1;
+    int last = -1;
 
-void PdfWidget::initEmptyPages()
-{
-    Q_D(PdfWidget);
+    for (int y = rect.top(); y <= rect.bottom();) {
+        const QModelIndex &index = view->indexAt(QPoint(view->spacing() + 1, y));
 
-    for(int i = 0; i < d->doc->pages(); i ++ ){
-        QListWidgetItem* pageItem = new QListWidgetItem;
-        pageItem->setSizeHint(DEFAULT_PAGE_SIZE);
+        // the gap between the items
+        if (!index.isValid()) {
+            y += qMax(1, view->spacing());
+            continue;
+        }
 
-        QListWidgetItem* thumbItem = new QListWidgetItem;
-        thumbItem->setSizeHint(DEFAULT_THUMB_SIZE);
+        if (first < 0) {
+            first = index.row();
+        }
 
-        d->pageListWidget->addItem(pageItem);
-        d->thumbListWidget->addItem(thumbItem);
+        last = index.row();
+        y = qMax(y + 1, view->visualRect(index).bottom() + 1);
     }
-}
-
-void PdfWidget::resizeCurrentPage()
-{
-    Q_D(PdfWidget);
 
-    QListWidgetItem* currentItem = d->pageListWidget->itemAt(d->pageListWidget->width() / 2, d->pageListWidget->height() / 2);
+    QList<int> visible;
+    QList<int> prefetch;
 
-    if(!currentItem)
-        return;
-
-    int currentRow = d->pageListWidget->row(currentItem);
-    int index = currentRow - DISPLAT_PAGE_NUM/2;
-    if(index < 0){
-        index = 0;
-    }
-    int counter = 0;
-    while(counter < DISPLAT_PAGE_NUM){
-        counter ++;
+    if (first >= 0) {
+        auto isRendered = [=] (int row) {
+            return d->imageCache.contains(cacheKey(kind, row, width));
+        };
 
-        if(d->pageMap.contains(index)){
-
-            QListWidgetItem* item = d->pageListWidget->item(index);
-            if(!item){
-                continue;
+        for (int row = first; row <= last; ++row) {
+            if (!isRendered(row)) {
+                visible << row;
             }
+        }
 
-            QWidget* w = d->pageListWidget->itemWidget(item);
-            if(!w){
-                continue;
+        // the pages below are more likely to be shown next
+        for (int i = 1; i <= prefetchCount; ++i) {
+            if (last + i < d->pageModel->rowCount() && !isRendered(last + i)) {
+                prefetch << last + i;
             }
 
-            QLabel* label = qobject_cast<QLabel*>(w);
-
-            QImage img = d->pageMap.value(index);
-            img = img.scaled(d->pageListWidget->width(), img.height(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            QImage page(d->pageListWidget->width(), img.height() + 4, QImage::Format_ARGB32_Premultiplied);
-            page.fill(Qt::white);
-
-            QPainter p(&page);
-            p.drawImage((page.width() - img.width()) / 2, 2, img);
-
-            if(index < (d->doc->pages() - 1)){
-                QPen pen(QColor(0, 0, 0 , 20));
-                p.setPen(pen);
-                p.drawLine(0, page.height() - 1, page.width(), page.height() - 1);
+            if (first - i >= 0 && !isRendered(first - i)) {
+                prefetch << first - i;
             }
-
-            label->setPixmap(QPixmap::fromImage(page));
-            item->setSizeHint(page.size());
-
-            index ++;
-        } else {
-            index ++;
-            continue;
         }
     }
+
+    // the pending jobs of the pages scrolled out of the view are dropped
+    d->renderScheduler->schedule(static_cast<PdfRenderScheduler::Kind>(kind), visible, prefetch, width);
 }
 
-PdfInitWorker::PdfInitWorker(QSharedPointer<poppler::document> doc, QObject *parent):
-    QObject(parent),
-    m_doc(doc)
+int PdfWidget::pageImageWidth() const
 {
+    Q_D(const PdfWidget);
 
+    return qRound(d->pageListView->viewport()->width() * devicePixelRatioF());
 }
 
-void PdfInitWorker::startGetPageThumb(int index)
+int PdfWidget::thumbImageWidth() const
 {
-    int counter = 0;
-    while(counter < DISPLAY_THUMB_NUM){
-        counter++;
-
-        //Skip for indexed thumb we got
-        if(m_gotThumbIndexes.contains(index)){
-            index ++;
-            continue;
-        }
-
-        QImage img = getRenderedPageImage(index);
-
-        if(img.isNull()){
-            break;
-        } else{
-            QImage thumb = getPageThumb(img);
-            emit thumbAdded(index, thumb);
-            m_gotThumbIndexes << index;
-            index ++;
-        }
-
-    }
+    // the thumbs of tall pages are narrower, but they are scaled down by a few pixels only
+    return qRound(DEFAULT_THUMB_SIZE.width() * devicePixelRatioF());
 }
 
-void PdfInitWorker::startGetPageImage(int index)
+PdfPageModel::PdfPageModel(int pageCount, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_aspects(pageCount, 0)
+    , m_defaultAspect(qreal(DEFAULT_PAGE_SIZE.height()) / DEFAULT_PAGE_SIZE.width())
 {
-    int counter = 0;
-    while(counter < DISPLAT_PAGE_NUM){
-        counter++;
 
-        //Skip for indexed page we got
-        if(m_gotPageIndexes.contains(index)){
-            index ++;
-            continue;
-        }
-
-        QImage img = getRenderedPageImage(index);
+}
 
-        if(img.isNull()){
-            break;
-        } else {
-            emit pageAdded(index, img);
-            m_gotPageIndexes << index;
-            index ++;
-        }
+int PdfPageModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
     }
+
+    return m_aspects.size();
 }
 
-QImage PdfInitWorker::getPageThumb(const QImage &img) const
+QVariant PdfPageModel::data(const QModelIndex &index, int role) const
 {
-    QImage newImg = img;
-    return newImg.scaled(DEFAULT_THUMB_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (!index.isValid() || role != AspectRole) {
+        return QVariant();
+    }
+
+    return aspect(index.row());
 }
 
-QImage PdfInitWorker::getRenderedPageImage(const int &index) const
+qreal PdfPageModel::aspect(int row) const
 {
-    QImage img;
+    const float aspect = m_aspects.value(row);
 
-    QSharedPointer<poppler::page> page = QSharedPointer<poppler::page>(m_doc->create_page(index));
+    return aspect > 0 ? aspect : m_defaultAspect;
+}
 
-    if (!page) {
-        return img;
+void PdfPageModel::setAspect(int row, qreal aspect)
+{
+    if (row < 0 || row >= m_aspects.size() || aspect <= 0) {
+        return;
     }
 
-    poppler::page_renderer pr;
-    pr.set_render_hint(poppler::page_renderer::antialiasing, true);
-    pr.set_render_hint(poppler::page_renderer::text_antialiasing, true);
+    // the thumb and the page are rendered at different sizes, ignore the rounding
+    if (qAbs(this->aspect(row) - aspect) < 0.02) {
+        m_aspects[row] = this->aspect(row);
+        m_hasDefaultAspect = true;
 
-    if(!pr.can_render()){
-        qDebug () << "Cannot render page";
-        return img;
-    }
-
-    if(page->page_rect().width() * page->page_rect().height() > 1920 * 1080 * 3){
-        qDebug () << "This pdf page is tool large, ignore...";
-        return img;
+        return;
     }
 
-    poppler::image imageData = pr.render_page(page.data());
-
-    if (!imageData.is_valid()) {
-        qDebug () << "Render error";
-        return img;
-    }
+    m_aspects[row] = aspect;
 
-    poppler::image::format_enum format = imageData.format();
-
-    switch (format) {
-    case poppler::image::format_invalid:
-        qDebug ()  << "Image format is invalid";
-        return img;
-    case poppler::image::format_mono:
-        img = QImage((uchar*)imageData.data(), imageData.width(), imageData.height(), QImage::Format_Mono);
-        break;
-    case poppler::image::format_rgb24:
-        img = QImage((uchar*)imageData.data(),imageData.width(),imageData.height(),QImage::Format_ARGB6666_Premultiplied);
-        break;
-    case poppler::image::format_argb32:
-    {
-        //Note that this format has problem that QImage cannot parse it normally
-        img = QImage(imageData.width(), imageData.height(), QImage::Format_ARGB32_Premultiplied);
-        img.fill(Qt::white);
-        int w = imageData.width();
-        int h = imageData.height();
-        int offset = imageData.bytes_per_row() / imageData.width();
-
-        char* pdata = imageData.data();
-
-        for(int y = 0; y < h; y ++){
-            for(int x = 0; x < w; x++){
-                uchar b = (uchar)pdata[(x * offset) + (y * w * offset)];
-                uchar g = (uchar)pdata[(x * offset) + (y * w * offset) + 1];
-                uchar r = (uchar)pdata[(x * offset) + (y * w * offset) + 2];
-                uchar a = (uchar)pdata[(x * offset) + (y * w * offset) + 3];
-
-                img.setPixelColor(x, y, QColor((int)r, (int)g, (int)b, (int)a));
-            }
-        }
-        break;
-    }
-    default:
-        break;
+    if (!m_hasDefaultAspect) {
+        m_hasDefaultAspect = true;
+        m_defaultAspect = aspect;
     }
 
-    return img;
+    emit layoutAboutToBeChanged();
+    emit layoutChanged();
 }
 
-DListWidget::DListWidget(QWidget *parent):
-    QListWidget(parent)
+DListView::DListView(QWidget *parent):
+    QListView(parent)
 {
 
 }
 
-void DListWidget::mouseMoveEvent(QMouseEvent *e)
+void DListView::mouseMoveEvent(QMouseEvent *e)
 {
     QWidget::mouseMoveEvent(e);
 }
+
+void DListView::resizeEvent(QResizeEvent *e)
+{
+    QListView::resizeEvent(e);
+
+    // the height of the items depends on the width of the view
+    if (e->size().width() != e->oldSize().width()) {
+        scheduleDelayedItemsLayout();
+    }
+}
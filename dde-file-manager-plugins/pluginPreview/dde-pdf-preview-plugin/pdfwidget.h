@@ -27,21 +27,21 @@
 
 #include <QWidget>
 #include <QSharedPointer>
-#include <QListWidget>
-#include <QLabel>
+#include <QListView>
+#include <QAbstractListModel>
+#include <QVector>
 
 #include "poppler-document.h"
-#include "poppler-page.h"
-#include "poppler-page-renderer.h"
 
 #define DEFAULT_VIEW_SIZE QSize(700, 800)
 #define DEFAULT_THUMB_SIZE QSize(55, 74)
 #define DEFAULT_PAGE_SIZE QSize(800, 1200)
-#define DISPLAY_THUMB_NUM 10
-#define DISPLAT_PAGE_NUM 5
+#define PREFETCH_THUMB_NUM 10
+#define PREFETCH_PAGE_NUM 2
+// the rendered pages are kept in a cache of this size, in KiB
+#define PAGE_CACHE_SIZE (64 * 1024)
 
 class PdfWidgetPrivate;
-class PdfInitWorker;
 class PdfWidget : public QWidget
 {
     Q_OBJECT
@@ -56,11 +56,15 @@ public:
 
     void showBadPage();
 
+    // returns the cached image of the page, null if it is not rendered at the size
+    QImage pageImage(int index, int width) const;
+    QImage thumbImage(int index, int width) const;
+
 public slots:
-    void onThumbAdded(int index, QImage img);
-    void onpageAdded(int index, QImage img);
+    void onPageRendered(int kind, int index, int width, const QImage &img);
     void onThumbScrollBarValueChanged(const int& val);
     void onPageScrollBarvalueChanged(const int& val);
+    void onThumbClicked(const QModelIndex &index);
     void startLoadCurrentPages();
     void startLoadCurrentThumbs();
 
@@ -68,48 +72,49 @@ protected:
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
 
 private:
-
-    void renderBorder(QImage& img);
-    void emptyBorder(QImage& img);
-
-    void loadPageSync(const int& index);
-    void loadThumbSync(const int& index);
-    void initEmptyPages();
-
-    void resizeCurrentPage();
+    void updateScrollBarVisible();
+    void scheduleRender(int kind);
+    int pageImageWidth() const;
+    int thumbImageWidth() const;
 
     QSharedPointer<PdfWidgetPrivate> d_ptr;
     Q_DECLARE_PRIVATE_D(qGetPtrHelper(d_ptr), PdfWidget)
 };
 
-class PdfInitWorker: public QObject{
+// One row for each page, no item is created for the pages, the views paint
+// the rendered images from the cache of PdfWidget.
+class PdfPageModel : public QAbstractListModel
+{
     Q_OBJECT
 public:
-    explicit PdfInitWorker(QSharedPointer<poppler::document> doc, QObject* parent = 0);
-
-    void startGetPageThumb(int index);
-    void startGetPageImage(int index);
+    enum Roles {
+        // height / width of the page
+        AspectRole = Qt::UserRole + 1
+    };
 
-signals:
-    void pageAdded(const int& index, const QImage& img);
-    void thumbAdded(const int& index, const QImage& img);
+    explicit PdfPageModel(int pageCount, QObject *parent = 0);
 
-private:
-    QImage getPageThumb(const QImage& img) const;
-    QImage getRenderedPageImage(const int& index) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
 
-    QList<int> m_gotThumbIndexes;
-    QList<int> m_gotPageIndexes;
+    qreal aspect(int row) const;
+    void setAspect(int row, qreal aspect);
 
-    QSharedPointer<poppler::document> m_doc;
+private:
+    // 0 until the page is rendered, the pages are assumed to have the size
+    // of the first rendered page
+    QVector<float> m_aspects;
+    qreal m_defaultAspect;
+    bool m_hasDefaultAspect = false;
 };
 
-class DListWidget: public QListWidget{
+class DListView: public QListView{
     Q_OBJECT
 public:
-    explicit DListWidget(QWidget* parent = 0);
+    explicit DListView(QWidget* parent = 0);
 protected:
     void mouseMoveEvent(QMouseEvent *e) Q_DECL_OVERRIDE;
+    void resizeEvent(QResizeEvent *e) Q_DECL_OVERRIDE;
 
 };
 
@@ -14,10 +14,12 @@ include(../../../common/common.pri)
 
 SOURCES += \
     main.cpp \
-    textpreview.cpp
+    textpreview.cpp \
+    textview.cpp
 
 HEADERS += \
-    textpreview.h
+    textpreview.h \
+    textview.h
 DISTFILES += \
     dde-text-preview-plugin.json
 
@@ -23,6 +23,7 @@
  */
 
 #include "textpreview.h"
+#include "textview.h"
 #include "dabstractfileinfo.h"
 #include "dfileservices.h"
 
@@ -32,10 +33,16 @@
 #include <QUrl>
 #include <QFileInfo>
 #include <QPlainTextEdit>
+#include <QStackedWidget>
 #include <QDebug>
 
 DFM_BEGIN_NAMESPACE
 
+namespace {
+// the larger files are mapped and paged instead of loading into QPlainTextEdit
+const qint64 LARGE_FILE_SIZE = 4 * 1024 * 1024;
+}
+
 TextPreview::TextPreview(QObject *parent):
     DFMFilePreview(parent)
 {
@@ -44,8 +51,8 @@ TextPreview::TextPreview(QObject *parent):
 
 TextPreview::~TextPreview()
 {
-    if (m_textBrowser)
-        m_textBrowser->deleteLater();
+    if (m_contentWidget)
+        m_contentWidget->deleteLater();
 }
 
 bool TextPreview::setFileUrl(const DUrl &url)
@@ -55,6 +62,35 @@ bool TextPreview::setFileUrl(const DUrl &url)
 
     m_url = url;
 
+    if (!m_contentWidget) {
+        m_contentWidget = new QStackedWidget();
+        m_contentWidget->setFixedSize(800, 500);
+
+        m_textBrowser = new QPlainTextEdit(m_contentWidget);
+        m_textBrowser->setReadOnly(true);
+        m_textBrowser->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
+        m_textBrowser->setWordWrapMode(QTextOption::NoWrap);
+        m_textBrowser->setFocusPolicy(Qt::NoFocus);
+
+        m_textView = new TextView(m_contentWidget);
+        m_textView->setFocusPolicy(Qt::NoFocus);
+
+        m_contentWidget->addWidget(m_textBrowser);
+        m_contentWidget->addWidget(m_textView);
+    }
+
+    m_title = QFileInfo(url.toLocalFile()).fileName();
+
+    if (url.isLocalFile() && QFileInfo(url.toLocalFile()).size() > LARGE_FILE_SIZE
+            && m_textView->setFile(url.toLocalFile())) {
+        m_textBrowser->clear();
+        m_contentWidget->setCurrentWidget(m_textView);
+
+        Q_EMIT titleChanged();
+
+        return true;
+    }
+
     QByteArray text;
 
     {
@@ -78,24 +114,15 @@ bool TextPreview::setFileUrl(const DUrl &url)
             return false;
         }
 
-        text = device->readAll();
+        // only the head of the large files which can't be mapped is shown
+        text = device->read(LARGE_FILE_SIZE);
     }
 
-    if (!m_textBrowser) {
-        m_textBrowser = new QPlainTextEdit();
-
-        m_textBrowser->setReadOnly(true);
-        m_textBrowser->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
-        m_textBrowser->setWordWrapMode(QTextOption::NoWrap);
-        m_textBrowser->setFixedSize(800, 500);
-        m_textBrowser->setFocusPolicy(Qt::NoFocus);
-    }
-
-
     QString convertedStr{ DFMGlobal::toUnicode(text, url.toLocalFile()) };
 
+    m_textView->clear();
     m_textBrowser->setPlainText(convertedStr);
-    m_title = QFileInfo(url.toLocalFile()).fileName();
+    m_contentWidget->setCurrentWidget(m_textBrowser);
 
     Q_EMIT titleChanged();
 
@@ -109,7 +136,7 @@ DUrl TextPreview::fileUrl() const
 
 QWidget *TextPreview::contentWidget() const
 {
-    return m_textBrowser;
+    return m_contentWidget;
 }
 
 QString TextPreview::title() const
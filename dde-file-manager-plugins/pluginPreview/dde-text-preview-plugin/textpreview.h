@@ -34,8 +34,11 @@
 
 QT_BEGIN_NAMESPACE
 class QPlainTextEdit;
+class QStackedWidget;
 QT_END_NAMESPACE
 
+class TextView;
+
 DFM_BEGIN_NAMESPACE
 
 class TextPreview : public DFMFilePreview
@@ -60,7 +63,10 @@ private:
     DUrl m_url;
     QString m_title;
 
-    QPointer<QPlainTextEdit> m_textBrowser;
+    QPointer<QStackedWidget> m_contentWidget;
+    QPlainTextEdit *m_textBrowser = nullptr;
+    // used for the large local files
+    TextView *m_textView = nullptr;
 };
 
 DFM_END_NAMESPACE
@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "textview.h"
+#include "dfmglobal.h"
+
+#include <QContextMenuEvent>
+#include <QInputDialog>
+#include <QMenu>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextCodec>
+#include <QTimer>
+#include <QWheelEvent>
+
+#include <string.h>
+#include <climits>
+
+namespace {
+// longer lines are split, so a line never costs more than this to decode
+const qint64 MAX_LINE_LENGTH = 4096;
+// the encoding is detected from the head of the file
+const int SAMPLE_SIZE = 64 * 1024;
+const int TEXT_MARGIN = 4;
+const int TAB_WIDTH = 4;
+}
+
+TextView::TextView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , m_tailTimer(new QTimer(this))
+{
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+
+    m_tailTimer->setInterval(1000);
+
+    connect(m_tailTimer, &QTimer::timeout, this, &TextView::checkFileSize);
+}
+
+bool TextView::setFile(const QString &filePath)
+{
+    clear();
+
+    m_file.setFileName(filePath);
+
+    if (!m_file.open(QIODevice::ReadOnly) || !mapFile(m_file.size())) {
+        clear();
+
+        return false;
+    }
+
+    const QByteArray &sample = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data),
+                                                       static_cast<int>(qMin<qint64>(m_size, SAMPLE_SIZE)));
+
+    m_codec = QTextCodec::codecForName(DFMGlobal::detectCharset(sample, filePath));
+
+    // the lines are split by the '\n' byte, which doesn't work for utf-16 and utf-32
+    if (m_codec && m_codec->mibEnum() >= 1013 && m_codec->mibEnum() <= 1019) {
+        clear();
+
+        return false;
+    }
+
+    updateScrollBars();
+    setTopOffset(0);
+
+    return true;
+}
+
+void TextView::clear()
+{
+    setFollowTail(false);
+
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+
+    m_file.close();
+    m_size = 0;
+    m_codec = nullptr;
+    m_topOffset = 0;
+    m_scrollScale = 1;
+    m_maxLineWidth = 0;
+
+    updateScrollBars();
+    viewport()->update();
+}
+
+void TextView::scrollToOffset(qint64 offset)
+{
+    setTopOffset(offset);
+}
+
+bool TextView::isFollowTail() const
+{
+    return m_followTail;
+}
+
+void TextView::setFollowTail(bool follow)
+{
+    m_followTail = follow;
+
+    if (follow) {
+        m_tailTimer->start();
+        checkFileSize();
+    } else {
+        m_tailTimer->stop();
+    }
+}
+
+void TextView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    // accessing the pages beyond the end of a truncated file raises SIGBUS
+    if (m_file.isOpen() && m_file.size() < m_size) {
+        checkFileSize();
+    }
+
+    QPainter painter(viewport());
+    const QFontMetrics &fm = fontMetrics();
+    const int x = TEXT_MARGIN - horizontalScrollBar()->value();
+    int max_width = m_maxLineWidth;
+    qint64 offset = m_topOffset;
+
+    painter.setPen(palette().color(QPalette::Text));
+
+    for (int y = 0; offset < m_size && y < viewport()->height(); y += fm.height()) {
+        const qint64 next = nextLine(offset);
+        const char *line = reinterpret_cast<const char *>(m_data + offset);
+        int length = static_cast<int>(next - offset);
+
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            --length;
+        }
+
+        QString text = m_codec ? m_codec->toUnicode(line, length) : QString::fromLocal8Bit(line, length);
+
+        text.replace('\t', QString(TAB_WIDTH, ' '));
+        painter.drawText(x, y + fm.ascent(), text);
+        max_width = qMax(max_width, fm.width(text) + 2 * TEXT_MARGIN);
+        offset = next;
+    }
+
+    if (max_width != m_maxLineWidth) {
+        m_maxLineWidth = max_width;
+        QTimer::singleShot(0, this, &TextView::updateScrollBars);
+    }
+}
+
+void TextView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+
+    updateScrollBars();
+    setTopOffset(m_followTail ? m_size : m_topOffset);
+}
+
+void TextView::wheelEvent(QWheelEvent *event)
+{
+    if (event->angleDelta().y() == 0) {
+        QAbstractScrollArea::wheelEvent(event);
+
+        return;
+    }
+
+    // 3 lines for each step of the wheel
+    m_wheelDelta += event->angleDelta().y();
+
+    const int lines = m_wheelDelta / 40;
+
+    m_wheelDelta -= lines * 40;
+
+    if (lines > 0) {
+        setFollowTail(false);
+    }
+
+    scrollLines(-lines);
+    event->accept();
+}
+
+void TextView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *go_to_action = menu.addAction(tr("Go to Offset..."));
+    QAction *follow_action = menu.addAction(tr("Follow the End of File"));
+
+    follow_action->setCheckable(true);
+    follow_action->setChecked(m_followTail);
+
+    QAction *action = menu.exec(event->globalPos());
+
+    if (action == follow_action) {
+        setFollowTail(follow_action->isChecked());
+    } else if (action == go_to_action) {
+        bool ok = false;
+        const QString &text = QInputDialog::getText(this, tr("Go to Offset"),
+                                                    tr("Byte offset, or percentage of the file (e.g. 50%):"),
+                                                    QLineEdit::Normal, QString(), &ok).trimmed();
+
+        if (!ok || text.isEmpty()) {
+            return;
+        }
+
+        qint64 offset = 0;
+
+        if (text.endsWith('%')) {
+            offset = static_cast<qint64>(m_size * text.left(text.size() - 1).toDouble(&ok) / 100);
+        } else {
+            offset = text.toLongLong(&ok, 0);
+        }
+
+        if (ok) {
+            setFollowTail(false);
+            scrollToOffset(offset);
+        }
+    }
+}
+
+void TextView::scrollContentsBy(int dx, int dy)
+{
+    if (dy != 0 && !m_updatingScrollBar) {
+        const qint64 last_page_offset = lastPageOffset();
+        qint64 offset = lineStart(qMin(verticalScrollBar()->value() * m_scrollScale, last_page_offset));
+
+        // the step of the scroll bar may be smaller than a line
+        if (dy < 0 && offset <= m_topOffset) {
+            offset = qMin(nextLine(m_topOffset), last_page_offset);
+        }
+
+        m_topOffset = offset;
+    }
+
+    Q_UNUSED(dx)
+
+    viewport()->update();
+}
+
+bool TextView::mapFile(qint64 size)
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+
+    m_size = 0;
+
+    // an empty file can't be mapped
+    if (size <= 0) {
+        return true;
+    }
+
+    m_data = m_file.map(0, size);
+
+    if (!m_data) {
+        return false;
+    }
+
+    m_size = size;
+    m_scrollScale = m_size / INT_MAX + 1;
+
+    return true;
+}
+
+qint64 TextView::lineStart(qint64 offset) const
+{
+    offset = qMin(offset, m_size);
+
+    if (offset <= 0) {
+        return 0;
+    }
+
+    const qint64 limit = qMax<qint64>(0, offset - MAX_LINE_LENGTH);
+    const void *end = memrchr(m_data + limit, '\n', static_cast<size_t>(offset - limit));
+
+    return end ? static_cast<const uchar *>(end) - m_data + 1 : limit;
+}
+
+qint64 TextView::nextLine(qint64 offset) const
+{
+    const qint64 length = qMin(m_size - offset, MAX_LINE_LENGTH);
+    const void *end = memchr(m_data + offset, '\n', static_cast<size_t>(length));
+
+    return end ? static_cast<const uchar *>(end) - m_data + 1 : offset + length;
+}
+
+qint64 TextView::lastPageOffset() const
+{
+    qint64 offset = m_size;
+
+    for (int i = pageLineCount(); i > 0 && offset > 0; --i) {
+        offset = lineStart(offset - 1);
+    }
+
+    return offset;
+}
+
+int TextView::pageLineCount() const
+{
+    return qMax(1, viewport()->height() / fontMetrics().height());
+}
+
+void TextView::setTopOffset(qint64 offset)
+{
+    m_topOffset = lineStart(qBound<qint64>(0, offset, lastPageOffset()));
+
+    m_updatingScrollBar = true;
+    verticalScrollBar()->setValue(static_cast<int>(m_topOffset / m_scrollScale));
+    m_updatingScrollBar = false;
+
+    viewport()->update();
+}
+
+void TextView::scrollLines(int lines)
+{
+    qint64 offset = m_topOffset;
+
+    for (; lines > 0 && offset < m_size; --lines) {
+        offset = nextLine(offset);
+    }
+
+    for (; lines < 0 && offset > 0; ++lines) {
+        offset = lineStart(offset - 1);
+    }
+
+    setTopOffset(offset);
+}
+
+void TextView::updateScrollBars()
+{
+    qint64 page_end = m_topOffset;
+
+    for (int i = pageLineCount(); i > 0 && page_end < m_size; --i) {
+        page_end = nextLine(page_end);
+    }
+
+    m_updatingScrollBar = true;
+
+    verticalScrollBar()->setRange(0, static_cast<int>(lastPageOffset() / m_scrollScale));
+    verticalScrollBar()->setPageStep(static_cast<int>(qMax<qint64>(1, (page_end - m_topOffset) / m_scrollScale)));
+    horizontalScrollBar()->setRange(0, qMax(0, m_maxLineWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth() * TAB_WIDTH);
+
+    m_updatingScrollBar = false;
+}
+
+void TextView::checkFileSize()
+{
+    const qint64 size = m_file.size();
+
+    if (size != m_size) {
+        if (!mapFile(size)) {
+            clear();
+
+            return;
+        }
+
+        updateScrollBars();
+    }
+
+    setTopOffset(m_followTail ? m_size : m_topOffset);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXTVIEW_H
+#define TEXTVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QFile>
+
+QT_BEGIN_NAMESPACE
+class QTextCodec;
+class QTimer;
+QT_END_NAMESPACE
+
+// Shows a large text file without loading it, the file is mapped and only
+// the lines in the viewport are decoded. The vertical scroll bar is a byte
+// offset in the file, so no line index has to be built.
+class TextView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit TextView(QWidget *parent = nullptr);
+
+    // returns false if the file can't be mapped or its encoding is not ascii compatible
+    bool setFile(const QString &filePath);
+    void clear();
+
+    // scrolls to the line which contains the byte offset
+    void scrollToOffset(qint64 offset);
+
+    bool isFollowTail() const;
+    // keeps the end of the file visible and reloads it when it grows, like tail -f
+    void setFollowTail(bool follow);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    bool mapFile(qint64 size);
+    qint64 lineStart(qint64 offset) const;
+    qint64 nextLine(qint64 offset) const;
+    qint64 lastPageOffset() const;
+    int pageLineCount() const;
+    void setTopOffset(qint64 offset);
+    void scrollLines(int lines);
+    void updateScrollBars();
+    void checkFileSize();
+
+    QFile m_file;
+    uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QTextCodec *m_codec = nullptr;
+
+    qint64 m_topOffset = 0;
+    // bytes per vertical scroll bar unit, the range of QScrollBar is int
+    qint64 m_scrollScale = 1;
+    int m_maxLineWidth = 0;
+    int m_wheelDelta = 0;
+    bool m_updatingScrollBar = false;
+    bool m_followTail = false;
+    QTimer *m_tailTimer;
+};
+
+#endif // TEXTVIEW_H
@@ -7,7 +7,7 @@
 include(../common/common.pri)
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-QT += network
+QT += network concurrent
 
 isEmpty(TARGET) {
     TARGET = $$ProjectName
@@ -50,7 +50,8 @@ SOURCES += \
     filemanagerapp.cpp \
     logutil.cpp \
     singleapplication.cpp \
-    commandlinemanager.cpp
+    commandlinemanager.cpp \
+    ipcprotocol.cpp
 
 INCLUDEPATH += $$PWD/../dde-file-manager-lib $$PWD/.. \
                $$PWD/../utils \
@@ -109,7 +110,8 @@ HEADERS += \
     filemanagerapp.h \
     logutil.h \
     singleapplication.h \
-    commandlinemanager.h
+    commandlinemanager.h \
+    ipcprotocol.h
 
 DISTFILES += \
     mips/dde-file-manager-autostart.desktop \
@@ -49,12 +49,15 @@
 #include "models/desktopfileinfo.h"
 #include "interfaces/dfileservices.h"
 #include "shutil/fileutils.h"
+#include "shutil/dfmstartuptrace.h"
 #include "utils/utils.h"
 #include "app/filesignalmanager.h"
 
 #include "tag/tagmanager.h"
 
 #include <QDataStream>
+#include <QApplication>
+#include <QEvent>
 #include <QGuiApplication>
 #include <QTimer>
 #include <QThreadPool>
@@ -66,11 +69,17 @@ Q_GLOBAL_STATIC(FileManagerAppGlobal, fmaGlobal)
 
 FileManagerApp::FileManagerApp(QObject *parent) : QObject(parent)
 {
+    DFMStartupTrace::Scope trace("FileManagerApp");
+
     initApp();
     initView();
     lazyRunInitServiceTask();
     initSysPathWatcher();
     initConnect();
+
+    // wait for the first paint of a window, there is no window in the daemon mode
+    qApp->installEventFilter(this);
+    QTimer::singleShot(1000, this, &FileManagerApp::initDeferredServices);
 }
 
 FileManagerApp *FileManagerApp::instance()
@@ -87,21 +96,20 @@ void FileManagerApp::initApp()
 {
     qDebug() << FileUtils::getKernelParameters();
 
+    DFMStartupTrace::begin("plugins");
+
     /*add plugin path*/
     DFMGlobal::autoLoadDefaultPlugins();
 
     /*init plugin manager */
     DFMGlobal::initPluginManager();
 
-    /*init searchHistoryManager */
-    DFMGlobal::initSearchHistoryManager();
+    DFMStartupTrace::end();
+    DFMStartupTrace::begin("managers");
 
     /*init bookmarkManager */
     DFMGlobal::initBookmarkManager();
 
-    /*init fileMenuManager */
-    DFMGlobal::initFileMenuManager();
-
     /*init fileSignalManger */
     DFMGlobal::initFileSiganlManager();
 
@@ -114,9 +122,15 @@ void FileManagerApp::initApp()
     /*init fileService */
     DFMGlobal::initFileService();
 
+    DFMStartupTrace::end();
+    DFMStartupTrace::begin("deviceListener");
+
     /*init deviceListener */
     DFMGlobal::initDeviceListener();
 
+    DFMStartupTrace::end();
+    DFMStartupTrace::begin("mimeAppsManager");
+
     /*init mimeAppsManager*/
     DFMGlobal::initMimesAppsManager();
 
@@ -126,17 +140,15 @@ void FileManagerApp::initApp()
     /*init mimeTypeDisplayManager */
     DFMGlobal::initMimeTypeDisplayManager();
 
-    /*init networkManager */
+    /*init networkManager, the first window may be a network url */
     DFMGlobal::initNetworkManager();
 
+    DFMStartupTrace::end();
+
     /*init gvfsMountManager */
     DFMGlobal::initGvfsMountManager();
 
-    /*init secretManger */
-    DFMGlobal::initSecretManager();
-
-    /*init userShareManager */
-    DFMGlobal::initUserShareManager();
+    DFMStartupTrace::begin("fileControllers");
 
     /*init controllers for different scheme*/
     fileService->initHandlersByCreators();
@@ -149,9 +161,49 @@ void FileManagerApp::initApp()
     /*init thumbnail connection*/
     DFMGlobal::initThumbnailConnection();
 
+    DFMStartupTrace::end();
+
     QThreadPool::globalInstance()->setMaxThreadCount(MAX_THREAD_COUNT);
 }
 
+void FileManagerApp::initDeferredServices()
+{
+    if (m_deferredServicesInited)
+        return;
+
+    m_deferredServicesInited = true;
+    qApp->removeEventFilter(this);
+
+    DFMStartupTrace::begin("deferredServices");
+
+    /*init searchHistoryManager */
+    DFMGlobal::initSearchHistoryManager();
+
+    /*init fileMenuManager */
+    DFMGlobal::initFileMenuManager();
+
+    /*init secretManger */
+    DFMGlobal::initSecretManager();
+
+    /*init userShareManager */
+    DFMGlobal::initUserShareManager();
+
+    DFMStartupTrace::end();
+    DFMStartupTrace::finish();
+}
+
+bool FileManagerApp::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && !m_deferredServicesInited
+            && watched->isWidgetType() && qobject_cast<DFileManagerWindow *>(static_cast<QWidget *>(watched)->window())) {
+        DFMStartupTrace::mark("first window painted");
+        // after the paint event is done
+        QTimer::singleShot(0, this, &FileManagerApp::initDeferredServices);
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
 void FileManagerApp::initView()
 {
     m_windowManager = WindowManager::instance();
@@ -54,6 +54,8 @@ public:
     void initConnect();
 
     static void initService();
+    // the services the first window doesn't need, run once it's painted
+    void initDeferredServices();
 
 //    QString getFileJobConfigPath();
 
@@ -64,9 +66,12 @@ public slots:
 protected:
     explicit FileManagerApp(QObject *parent = 0);
 
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
     WindowManager* m_windowManager = NULL;
     QFileSystemWatcher* m_sysPathWatcher;
+    bool m_deferredServicesInited = false;
 };
 
 #endif // FILEMANAGERAPP_H
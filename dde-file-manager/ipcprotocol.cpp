@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ipcprotocol.h"
+
+#include <QDataStream>
+#include <QtEndian>
+
+// the arguments of a request are paths, a bigger frame is garbage
+#define MAX_FRAME_SIZE (16 * 1024 * 1024)
+
+QByteArray IpcProtocol::magic()
+{
+    // never the first byte of the base64 arguments of the old clients
+    return QByteArrayLiteral("\0DFMIPC1");
+}
+
+QByteArray IpcProtocol::encode(const Message &message)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream.setVersion(QDataStream::Qt_5_0);
+    // the size is written when the payload is done
+    stream << quint32(0) << message.id << quint8(message.type) << message.arguments;
+    stream.device()->seek(0);
+    stream << quint32(data.size() - sizeof(quint32));
+
+    return data;
+}
+
+IpcProtocol::DecodeResult IpcProtocol::decode(QByteArray &buffer, Message &message)
+{
+    if (buffer.size() < int(sizeof(quint32)))
+        return NeedMoreData;
+
+    const quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer.constData()));
+
+    if (size > MAX_FRAME_SIZE)
+        return InvalidData;
+
+    if (quint32(buffer.size()) - sizeof(quint32) < size)
+        return NeedMoreData;
+
+    quint8 type = 0;
+    bool ok = false;
+
+    {
+        QDataStream stream(QByteArray::fromRawData(buffer.constData() + sizeof(quint32), size));
+
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> message.id >> type >> message.arguments;
+        ok = stream.status() == QDataStream::Ok;
+    }
+
+    buffer.remove(0, sizeof(quint32) + size);
+    message.type = static_cast<Type>(type);
+
+    return ok ? Decoded : InvalidData;
+}
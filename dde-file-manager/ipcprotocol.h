@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef IPCPROTOCOL_H
+#define IPCPROTOCOL_H
+
+#include <QByteArray>
+#include <QStringList>
+
+// The messages between the instances over the local socket. A connection
+// starts with the magic, then every message is a frame of a big endian
+// quint32 size and the QDataStream of the id, the type and the arguments.
+// A reply has the id of its request, so a client may send many requests on
+// one connection and read the replies later. The clients connect to
+// SingleApplication::ipcServerName, the older builds only listen on the
+// legacy name and only read the base64 arguments of a command line.
+class IpcProtocol
+{
+public:
+    enum Type : quint8 {
+        // the arguments of a whole command line, as processed by CommandLineManager
+        Command = 1,
+        // the arguments are the paths or the urls to open
+        Open,
+        // the arguments are the files to select in their directories
+        Select,
+        // replies the monitored files
+        QueryMonitorFiles,
+        // replies the statistics of DFMEventDispatcher, resets them if the argument is "reset"
+        QueryEventStatistics,
+        // replies the queue depth and the task counts of the DFMExecutor pools
+        QueryExecutorStatistics,
+
+        Reply = 0x80,
+        Error
+    };
+
+    struct Message
+    {
+        quint32 id = 0;
+        Type type = Command;
+        QStringList arguments;
+    };
+
+    enum DecodeResult {
+        Decoded,
+        NeedMoreData,
+        InvalidData
+    };
+
+    static QByteArray magic();
+
+    static QByteArray encode(const Message &message);
+    // takes the first frame out of the buffer
+    static DecodeResult decode(QByteArray &buffer, Message &message);
+};
+
+#endif // IPCPROTOCOL_H
@@ -48,6 +48,8 @@
 #include "gvfs/gvfsmountmanager.h"
 
 #include "dfmapplication.h"
+#include "shutil/dfmstartuptrace.h"
+#include "views/windowmanager.h"
 
 #include <QApplication>
 #include <QDebug>
@@ -93,11 +95,20 @@ int main(int argc, char *argv[])
     // Fixed the locale codec to utf-8
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("utf-8"));
 
+    // the requests of the scripts are piped to the running instance, the gui is not needed
+    if (argc == 2 && qstrcmp(argv[1], "--pipe") == 0) {
+        QCoreApplication app(argc, argv);
+
+        return SingleApplication::execPipeClient(QMAKE_TARGET);
+    }
+
     if (qEnvironmentVariableIsSet("PKEXEC_UID")) {
         const quint32 pkexecUID = qgetenv("PKEXEC_UID").toUInt();
         DApplication::customQtThemeConfigPathByUserHome(getpwuid(pkexecUID)->pw_dir);
     }
 
+    DFMStartupTrace::begin("application");
+
     SingleApplication::loadDXcbPlugin();
     SingleApplication::initSources();
     SingleApplication app(argc, argv);
@@ -126,10 +137,15 @@ int main(int argc, char *argv[])
 
     LogUtil::registerLogger();
 
+    DFMStartupTrace::end();
+    DFMStartupTrace::begin("DFMApplication");
+
     // init application object
     DFMApplication fmApp;
     Q_UNUSED(fmApp)
 
+    DFMStartupTrace::end();
+
     // init pixmap cache size limit, 20MB * devicePixelRatio
     QPixmapCache::setCacheLimit(20 * 1024 * app.devicePixelRatio());
 
@@ -166,6 +182,8 @@ int main(int argc, char *argv[])
 
         if (CommandLineManager::instance()->isSet("d")) {
             fileManagerApp;
+            // the window requests of the resident process show a preloaded window
+            WindowManager::instance()->setPreloadWindowEnabled(true);
 #ifdef AUTO_RESTART_DEAMON
             QWidget w;
             w.setWindowFlags(Qt::FramelessWindowHint | Qt::X11BypassWindowManagerHint);
@@ -174,6 +192,8 @@ int main(int argc, char *argv[])
             w.show();
 #endif
         } else {
+            DFMStartupTrace::Scope trace("processCommand");
+
             CommandLineManager::instance()->processCommand();
         }
 
@@ -194,7 +214,7 @@ int main(int argc, char *argv[])
         return ret;
 #endif
     } else {
-        QByteArray data;
+        IpcProtocol::Message message;
         bool is_set_get_monitor_files = false;
 
         for (const QString &arg : app.arguments()) {
@@ -202,17 +222,13 @@ int main(int argc, char *argv[])
                 is_set_get_monitor_files = true;
 
             if (!arg.startsWith("-") && QFile::exists(arg))
-                data.append(QDir(arg).absolutePath().toLocal8Bit().toBase64());
+                message.arguments << QDir(arg).absolutePath();
             else
-                data.append(arg.toLocal8Bit().toBase64());
-
-            data.append(' ');
+                message.arguments << arg;
         }
 
-        if (!data.isEmpty())
-            data.chop(1);
-
-        QLocalSocket *socket = SingleApplication::newClientProcess(uniqueKey, data);
+        bool framed = false;
+        QLocalSocket *socket = SingleApplication::newClientProcess(uniqueKey, message, &framed);
         QWidget w;
         w.setWindowFlags(Qt::FramelessWindowHint | Qt::X11BypassWindowManagerHint);
         w.setAttribute(Qt::WA_TranslucentBackground);
@@ -220,10 +236,25 @@ int main(int argc, char *argv[])
         w.show();
 
         if (is_set_get_monitor_files && socket->error() == QLocalSocket::UnknownSocketError) {
-            socket->waitForReadyRead();
+            if (framed) {
+                QByteArray buffer;
+                IpcProtocol::Message reply;
+
+                while (socket->waitForReadyRead()) {
+                    buffer.append(socket->readAll());
+
+                    if (IpcProtocol::decode(buffer, reply) != IpcProtocol::NeedMoreData)
+                        break;
+                }
+
+                for (const QString &i : reply.arguments)
+                    qDebug() << i;
+            } else {
+                socket->waitForReadyRead();
 
-            for (const QByteArray &i : socket->readAll().split(' '))
-                qDebug() << QString::fromLocal8Bit(QByteArray::fromBase64(i));
+                for (const QByteArray &i : socket->readAll().split(' '))
+                    qDebug() << QString::fromLocal8Bit(QByteArray::fromBase64(i));
+            }
         }
 
         return 0;
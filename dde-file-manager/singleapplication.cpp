@@ -34,21 +34,45 @@
 #include "filemanagerapp.h"
 #include "dfmevent.h"
 #include "interfaces/dfileservices.h"
+#include "shutil/dfmexecutor.h"
 
 #include <QProcess>
 #include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QPointer>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QStandardPaths>
+#include <QTextStream>
 #include <QTranslator>
 
+DFM_USE_NAMESPACE
+
 #define fileManagerApp FileManagerApp::instance()
 
 QString SingleApplication::UserID = "1000";
 
+namespace {
+struct IpcConnection
+{
+    enum Protocol {
+        Unknown,
+        Legacy,
+        Framed
+    };
+
+    Protocol protocol = Unknown;
+    QByteArray buffer;
+};
+
+QHash<QLocalSocket*, IpcConnection> ipcConnections;
+}
+
 SingleApplication::SingleApplication(int &argc, char **argv, int): DApplication(argc, argv)
 {
     m_localServer = new QLocalServer;
+    m_ipcServer = new QLocalServer;
     initConnect();
 }
 
@@ -60,6 +84,7 @@ SingleApplication::~SingleApplication()
 void SingleApplication::initConnect()
 {
     connect(m_localServer, &QLocalServer::newConnection, this, &SingleApplication::handleConnection);
+    connect(m_ipcServer, &QLocalServer::newConnection, this, &SingleApplication::handleConnection);
 }
 
 void SingleApplication::initSources()
@@ -69,16 +94,39 @@ void SingleApplication::initSources()
 //    Q_INIT_RESOURCE(dui_theme_light);
 }
 
-QLocalSocket *SingleApplication::newClientProcess(const QString &key, const QByteArray &message)
+QLocalSocket *SingleApplication::newClientProcess(const QString &key, const IpcProtocol::Message &message, bool *framed)
 {
     QLocalSocket *localSocket = new QLocalSocket;
-    localSocket->connectToServer(userServerName(key));
-    if (localSocket->waitForConnected(1000)){
-        if (localSocket->state() == QLocalSocket::ConnectedState){
-            if (localSocket->isValid()) {
-                localSocket->write(message);
-                localSocket->flush();
-            }
+    QByteArray data;
+    bool is_framed = false;
+
+    localSocket->connectToServer(ipcServerName(key));
+
+    if (localSocket->waitForConnected(1000)) {
+        data = IpcProtocol::magic() + IpcProtocol::encode(message);
+        is_framed = true;
+    } else {
+        // an instance of an older build only listens on the legacy name and
+        // reads the space separated base64 arguments of a command line
+        delete localSocket;
+        localSocket = new QLocalSocket;
+        localSocket->connectToServer(userServerName(key));
+
+        if (localSocket->waitForConnected(1000)) {
+            for (const QString &arg : message.arguments)
+                data.append(arg.toLocal8Bit().toBase64()).append(' ');
+
+            data.chop(1);
+        }
+    }
+
+    if (framed)
+        *framed = is_framed;
+
+    if (localSocket->state() == QLocalSocket::ConnectedState){
+        if (localSocket->isValid()) {
+            localSocket->write(data);
+            localSocket->flush();
         }
     }else{
         qDebug() << localSocket->errorString();
@@ -87,6 +135,108 @@ QLocalSocket *SingleApplication::newClientProcess(const QString &key, const QByt
     return localSocket;
 }
 
+int SingleApplication::execPipeClient(const QString &key)
+{
+    QLocalSocket socket;
+
+    socket.connectToServer(ipcServerName(key));
+
+    // the instances of the older builds don't take the framed requests
+    if (!socket.waitForConnected(1000)) {
+        qWarning() << "no instance to send the requests to:" << socket.errorString();
+
+        return 1;
+    }
+
+    QTextStream input(stdin);
+    QTextStream output(stdout);
+    QByteArray buffer;
+    quint32 last_id = 0;
+    int pending = 0;
+
+    socket.write(IpcProtocol::magic());
+
+    auto read_replies = [&] (int timeout) {
+        if (!socket.waitForReadyRead(timeout))
+            return false;
+
+        buffer.append(socket.readAll());
+
+        IpcProtocol::Message reply;
+        IpcProtocol::DecodeResult result;
+
+        while ((result = IpcProtocol::decode(buffer, reply)) == IpcProtocol::Decoded) {
+            --pending;
+            output << reply.id << '\t' << (reply.type == IpcProtocol::Reply ? "ok" : "error");
+
+            for (const QString &arg : reply.arguments)
+                output << '\t' << arg;
+
+            output << endl;
+        }
+
+        return result == IpcProtocol::NeedMoreData;
+    };
+
+    // a request per line: "open <path>", "select <path>", "monitor-files",
+    // "event-stats [reset]" or "executor-stats"
+    forever {
+        const QString &raw_line = input.readLine();
+
+        if (raw_line.isNull())
+            break;
+
+        const QString &line = raw_line.trimmed();
+
+        if (line.isEmpty())
+            continue;
+
+        const QString &verb = line.section(' ', 0, 0);
+        const QString &path = line.section(' ', 1).trimmed();
+        IpcProtocol::Message request;
+
+        if (verb == "open") {
+            request.type = IpcProtocol::Open;
+        } else if (verb == "select") {
+            request.type = IpcProtocol::Select;
+        } else if (verb == "monitor-files") {
+            request.type = IpcProtocol::QueryMonitorFiles;
+        } else if (verb == "event-stats") {
+            request.type = IpcProtocol::QueryEventStatistics;
+        } else if (verb == "executor-stats") {
+            request.type = IpcProtocol::QueryExecutorStatistics;
+        } else {
+            qWarning() << "unknown request:" << line;
+            continue;
+        }
+
+        if (request.type == IpcProtocol::QueryEventStatistics || request.type == IpcProtocol::QueryExecutorStatistics) {
+            if (!path.isEmpty())
+                request.arguments << path;
+        } else if (!path.isEmpty()) {
+            request.arguments << (QFile::exists(path) ? QDir(path).absolutePath() : path);
+        }
+
+        request.id = ++last_id;
+        ++pending;
+        output << request.id << '\t' << line << endl;
+
+        // the requests are not waited for, only the replies already arrived are read
+        socket.write(IpcProtocol::encode(request));
+        socket.flush();
+
+        if (!read_replies(0) && socket.state() != QLocalSocket::ConnectedState)
+            return 1;
+    }
+
+    while (pending > 0) {
+        if (!read_replies(30000))
+            return 1;
+    }
+
+    return 0;
+}
+
 QString SingleApplication::userServerName(const QString &key)
 {
     QString userKey;
@@ -100,6 +250,11 @@ QString SingleApplication::userServerName(const QString &key)
     return userKey;
 }
 
+QString SingleApplication::ipcServerName(const QString &key)
+{
+    return userServerName(key) + QStringLiteral(".ipc1");
+}
+
 QString SingleApplication::userId()
 {
     return UserID;
@@ -174,14 +329,32 @@ bool SingleApplication::setSingleInstance(const QString &key)
 
     bool f = m_localServer->listen(userKey);
 
+    if (f) {
+        const QString &ipcKey = ipcServerName(key);
+
+        m_ipcServer->removeServer(ipcKey);
+
+        if (!m_ipcServer->listen(ipcKey))
+            qWarning() << "can't listen on" << ipcKey << m_ipcServer->errorString();
+    }
+
     return f;
 }
 
 void SingleApplication::handleConnection()
 {
     qDebug() << "new connection is coming";
-    QLocalSocket* nextPendingConnection = m_localServer->nextPendingConnection();
+    QLocalServer *server = qobject_cast<QLocalServer*>(sender());
+
+    if (!server)
+        return;
+
+    QLocalSocket* nextPendingConnection = server->nextPendingConnection();
     connect(nextPendingConnection, SIGNAL(readyRead()), this, SLOT(readData()));
+    connect(nextPendingConnection, &QLocalSocket::disconnected, nextPendingConnection, &QLocalSocket::deleteLater);
+    connect(nextPendingConnection, &QLocalSocket::destroyed, this, [nextPendingConnection] {
+        ipcConnections.remove(nextPendingConnection);
+    });
 }
 
 void SingleApplication::readData()
@@ -191,9 +364,69 @@ void SingleApplication::readData()
     if (!socket)
         return;
 
+    IpcConnection &connection = ipcConnections[socket];
+
+    connection.buffer.append(socket->readAll());
+
+    if (connection.protocol == IpcConnection::Unknown) {
+        const QByteArray &magic = IpcProtocol::magic();
+        const int size = qMin(magic.size(), connection.buffer.size());
+
+        if (connection.buffer.left(size) != magic.left(size)) {
+            connection.protocol = IpcConnection::Legacy;
+        } else if (size == magic.size()) {
+            connection.protocol = IpcConnection::Framed;
+            connection.buffer.remove(0, size);
+        } else {
+            return;
+        }
+    }
+
+    if (connection.protocol == IpcConnection::Legacy) {
+        const QByteArray data = connection.buffer;
+
+        connection.buffer.clear();
+        readLegacyData(socket, data);
+
+        return;
+    }
+
+    QPointer<QLocalSocket> socket_pointer(socket);
+    IpcProtocol::Message message;
+    QByteArray replies;
+
+    forever {
+        IpcProtocol::DecodeResult result = IpcProtocol::decode(ipcConnections[socket].buffer, message);
+
+        if (result == IpcProtocol::NeedMoreData)
+            break;
+
+        if (result == IpcProtocol::InvalidData) {
+            qWarning() << "invalid ipc message, close the connection";
+            socket->disconnectFromServer();
+
+            return;
+        }
+
+        // a request may open a dialog and run an event loop, the socket may be gone after it
+        replies.append(IpcProtocol::encode(handleMessage(message)));
+
+        if (!socket_pointer)
+            return;
+    }
+
+    if (!replies.isEmpty()) {
+        socket->write(replies);
+        socket->flush();
+    }
+}
+
+void SingleApplication::readLegacyData(QLocalSocket *socket, const QByteArray &data)
+{
+    // the space separated base64 arguments of the old clients
     QStringList arguments;
 
-    for (const QByteArray &arg_base64 : socket->read(1024).split(' ')) {
+    for (const QByteArray &arg_base64 : data.split(' ')) {
         const QByteArray &arg = QByteArray::fromBase64(arg_base64.simplified());
 
         if (arg.isEmpty())
@@ -219,12 +452,69 @@ void SingleApplication::readData()
     CommandLineManager::instance()->processCommand();
 }
 
+IpcProtocol::Message SingleApplication::handleMessage(const IpcProtocol::Message &message)
+{
+    IpcProtocol::Message reply;
+
+    reply.id = message.id;
+    reply.type = IpcProtocol::Reply;
+
+    switch (message.type) {
+    case IpcProtocol::Command:
+        CommandLineManager::instance()->process(message.arguments);
+
+        if (CommandLineManager::instance()->isSet("get-monitor-files")) {
+            reply.arguments = DFileWatcher::getMonitorFiles();
+        } else {
+            CommandLineManager::instance()->processCommand();
+        }
+        break;
+    case IpcProtocol::Open:
+    case IpcProtocol::Select: {
+        // the paths are never taken as the options
+        QStringList arguments = QStringList() << applicationFilePath();
+
+        if (message.type == IpcProtocol::Select)
+            arguments << "--show-item";
+
+        arguments << "--" << message.arguments;
+
+        CommandLineManager::instance()->process(arguments);
+        CommandLineManager::instance()->processCommand();
+        break;
+    }
+    case IpcProtocol::QueryMonitorFiles:
+        reply.arguments = DFileWatcher::getMonitorFiles();
+        break;
+    case IpcProtocol::QueryEventStatistics:
+        reply.arguments = DFMEventDispatcher::instance()->eventStatistics();
+
+        if (message.arguments.contains("reset"))
+            DFMEventDispatcher::instance()->resetEventStatistics();
+        break;
+    case IpcProtocol::QueryExecutorStatistics:
+        reply.arguments = DFMExecutor::statistics();
+        break;
+    default:
+        reply.type = IpcProtocol::Error;
+        reply.arguments << QString("unknown request type %1").arg(message.type);
+        break;
+    }
+
+    return reply;
+}
+
 void SingleApplication::closeServer()
 {
     if (m_localServer){
         m_localServer->removeServer(m_localServer->serverName());
         m_localServer->close();
     }
+
+    if (m_ipcServer && m_ipcServer->isListening()) {
+        m_ipcServer->removeServer(m_ipcServer->serverName());
+        m_ipcServer->close();
+    }
 }
 
 void SingleApplication::handleQuitAction()
@@ -30,6 +30,8 @@
 #include <DApplication>
 #include <durl.h>
 
+#include "ipcprotocol.h"
+
 QT_BEGIN_NAMESPACE
 class QLocalServer;
 class QLocalSocket;
@@ -46,8 +48,14 @@ public:
     void initConnect();
 
     static void initSources();
-    static QLocalSocket *newClientProcess(const QString& key, const QByteArray &message);
+    // sends the message on the framed protocol, or as a legacy command line if the
+    // running instance is of an older build, framed tells which one was used
+    static QLocalSocket *newClientProcess(const QString& key, const IpcProtocol::Message &message, bool *framed = nullptr);
+    // sends the requests read from stdin on one connection, only needs a QCoreApplication
+    static int execPipeClient(const QString& key);
     static QString userServerName(const QString& key);
+    // the name of the server only taking the framed requests, the older builds don't listen on it
+    static QString ipcServerName(const QString& key);
     static QString userId();
 
     bool loadTranslator(QList<QLocale> localeFallback = QList<QLocale>() << QLocale::system());
@@ -64,10 +72,14 @@ public slots:
 private:
     void handleQuitAction() Q_DECL_OVERRIDE;
 
+    void readLegacyData(QLocalSocket *socket, const QByteArray &data);
+    IpcProtocol::Message handleMessage(const IpcProtocol::Message &message);
+
     static QString getUserID();
 
     static QString UserID;
     QLocalServer* m_localServer;
+    QLocalServer* m_ipcServer;
 };
 
 #endif // SINGLEAPPLICATION_H
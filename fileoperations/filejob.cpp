@@ -60,7 +60,12 @@
 #include <QCryptographicHash>
 #include <QMetaEnum>
 #include <QStorageInfo>
+#include <QtConcurrent>
 
+#include <algorithm>
+#include <limits>
+
+#include <dirent.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -76,6 +81,9 @@
 
 DFM_USE_NAMESPACE
 
+// the manifest is dropped past this, copyDir lists the remaining directories itself
+#define MAX_MANIFEST_ENTRIES 500000
+
 int FileJob::FileJobCount = 0;
 DUrlList FileJob::CopyingFiles = {};
 qint64 FileJob::Msec_For_Display = 1000;
@@ -132,6 +140,9 @@ FileJob::FileJob(JobType jobType, QObject *parent) : QObject(parent)
 
 FileJob::~FileJob()
 {
+    if (m_stopTotalSizeScan)
+        m_stopTotalSizeScan->store(1);
+
 #ifdef SPLICE_CP
     close(m_filedes[0]);
     close(m_filedes[1]);
@@ -318,6 +329,21 @@ DUrlList FileJob::doMoveCopyJob(const DUrlList &files, const DUrl &destination)
     qDebug() << "m_isInSameDisk" << m_isInSameDisk;
     qDebug() << "mountpoint" << tarStorageInfo.rootPath();
 
+    // 与 DFileCopyMoveJob 相同, 只对可移除设备限制写回, 内部磁盘的写回由内核处理即可
+    m_throttleWriteBack = false;
+
+    if (!m_isInSameDisk && tarStorageInfo.isValid()) {
+        QProcess process;
+
+        process.start("lsblk", {"-ndro", "HOTPLUG", QString::fromLocal8Bit(tarStorageInfo.device())}, QIODevice::ReadOnly);
+
+        if (process.waitForFinished(3000) && process.exitCode() == 0) {
+            m_throttleWriteBack = process.readAllStandardOutput().trimmed() == "1";
+        }
+    }
+
+    qDebug() << "throttle write back" << m_throttleWriteBack;
+
     //No need to check dist usage for moving job in same disk
     if(!((m_jobType == Move || m_jobType == Trash || m_jobType == Restore) && m_isInSameDisk)){
         const bool diskSpaceAvailable = checkDiskSpaceAvailable(files, destination);
@@ -328,7 +354,7 @@ DUrlList FileJob::doMoveCopyJob(const DUrlList &files, const DUrl &destination)
             return DUrlList();
         }
     } else{
-        m_totalSize = FileUtils::totalSize(files);
+        startTotalSizeScan(files);
     }
 
     qDebug() << "m_totalSize" << FileUtils::formatSize(m_totalSize);
@@ -812,6 +838,13 @@ void FileJob::cancelled()
 void FileJob::handleJobFinished()
 {
     qDebug() << m_status;
+
+    if (m_stopTotalSizeScan)
+        m_stopTotalSizeScan->store(1);
+
+    if (!totalSizeReady())
+        m_totalSize = qMax(m_bytesCopied, qint64(1));
+
     m_bytesCopied = m_totalSize;
     m_bytesPerSec = -1;
     m_isFinished = true;
@@ -856,6 +889,9 @@ void FileJob::jobUpdated()
             }
         }
     }else{
+        // the progress is unknown until the sources are counted
+        const bool isTotalSizeReady = m_isFinished || totalSizeReady();
+
         if (!m_isFinished){
 
             qint64 currentMsec = m_timer.elapsed();
@@ -871,14 +907,16 @@ void FileJob::jobUpdated()
                 return;
             }
 
-            if(m_bytesPerSec > 0)
+            if(m_bytesPerSec > 0 && isTotalSizeReady)
             {
                 if (m_totalSize < m_bytesCopied){
                     qDebug() << "error copying file by growing" << m_totalSize << m_bytesCopied;
                     m_totalSize = m_bytesCopied;
                     cancelled();
                 }else{
-                    int remainTime = (m_totalSize - m_bytesCopied) / m_bytesPerSec;
+                    // the device speed is steadier than the speed of writing to the page cache
+                    const qint64 writeSpeed = m_writeBackThrottle.speed() > 0 ? m_writeBackThrottle.speed() : m_bytesPerSec;
+                    int remainTime = (m_totalSize - m_bytesCopied) / writeSpeed;
 
                     if (remainTime < 60){
                         jobDataDetail.insert("remainTime", tr("%1 s").arg(QString::number(remainTime)));
@@ -927,9 +965,10 @@ void FileJob::jobUpdated()
 
         jobDataDetail.insert("speed", speed);
         jobDataDetail.insert("file", m_srcFileName);
-        jobDataDetail.insert("progress", QString::number(m_bytesCopied * 100/ m_totalSize));
+        if (isTotalSizeReady)
+            jobDataDetail.insert("progress", QString::number(m_bytesCopied * 100/ m_totalSize));
         jobDataDetail.insert("destination", m_tarDirName);
-        m_progress = jobDataDetail.value("progress");
+        m_progress = jobDataDetail.value("progress", m_progress);
     }
 //    qDebug() << m_jobDetail << jobDataDetail;
     emit requestJobDataUpdated(m_jobDetail, jobDataDetail);
@@ -1209,6 +1248,9 @@ bool FileJob::copyFile(const QString &srcFile, const QString &tarDir, bool isMov
                 }
                 posix_fadvise (from.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
 
+                if (m_throttleWriteBack)
+                    m_writeBackThrottle.beginFile(to.handle());
+
                 CopyingFiles.append(DUrl::fromLocalFile(m_tarPath));
 
                 m_status = Run;
@@ -1276,13 +1318,15 @@ bool FileJob::copyFile(const QString &srcFile, const QString &tarDir, bool isMov
                     }
                 }
 #else
-                qint64 inBytes = from.read(m_bufferAlign, Data_Block_Size);
+                qint64 inBytes = from.read(m_bufferAlign, m_throttleWriteBack ? m_writeBackThrottle.blockSize(int(Data_Block_Size)) : Data_Block_Size);
 
                 if(inBytes == 0)
                 {
                     if ((m_totalSize - m_bytesCopied) <= 1){
                         m_bytesCopied = m_totalSize;
                     }
+                    if (m_throttleWriteBack)
+                        m_writeBackThrottle.endFile();
                     to.close();
                     from.close();
 
@@ -1315,6 +1359,9 @@ bool FileJob::copyFile(const QString &srcFile, const QString &tarDir, bool isMov
 
                 m_bytesCopied += inBytes;
                 m_bytesPerSec += inBytes;
+
+                if (m_throttleWriteBack)
+                    m_writeBackThrottle.fileWritten(to.pos());
 #endif
                 break;
             }
@@ -1616,23 +1663,10 @@ bool FileJob::copyDir(const QString &srcDir, const QString &tarDir, bool isMoved
         }
         case Run:
         {
-
-            char *name_space;
-            char *namep;
-            name_space = savedir(srcDir.toStdString().data());
-            namep = name_space;
-
-            // 打开目录失败则跳过此目录
-            if (!namep)
-                return false;
-
-            while (*namep != '\0')
-            {
-                QString srcFile = QString("%1/%2").arg(srcDir, QString(namep));
-                QFileInfo srcFileInfo(srcFile);
-                if (srcFileInfo.isSymLink()){
+            auto copyEntry = [&] (const QString &srcFile, bool isSymLink, bool isDir) {
+                if (isSymLink){
                     handleSymlinkFile(srcFile, targetDir.absolutePath());
-                }else if(!srcFileInfo.isSymLink() && srcFileInfo.isDir()){
+                }else if(isDir){
                     if(!copyDir(srcFile, targetDir.absolutePath(), isMoved)){
                         qDebug() << "coye dir" << srcFile << "failed";
                     }
@@ -1643,9 +1677,38 @@ bool FileJob::copyDir(const QString &srcDir, const QString &tarDir, bool isMoved
                         qDebug() << "coye file" << srcFile << "failed";
                     }
                 }
-                namep += strlen (namep) + 1;
+            };
+
+            // the directory was listed when the disk space was checked
+            auto manifest = m_manifest.find(srcDir);
+
+            if (manifest != m_manifest.end()) {
+                const QVector<ManifestEntry> entries = manifest.value();
+
+                m_manifest.erase(manifest);
+
+                for (const ManifestEntry &entry : entries) {
+                    copyEntry(QString("%1/%2").arg(srcDir, entry.name), S_ISLNK(entry.mode), S_ISDIR(entry.mode));
+                }
+            } else {
+                char *name_space;
+                char *namep;
+                name_space = savedir(srcDir.toStdString().data());
+                namep = name_space;
+
+                // 打开目录失败则跳过此目录
+                if (!namep)
+                    return false;
+
+                while (*namep != '\0')
+                {
+                    QString srcFile = QString("%1/%2").arg(srcDir, QString(namep));
+                    QFileInfo srcFileInfo(srcFile);
+                    copyEntry(srcFile, srcFileInfo.isSymLink(), !srcFileInfo.isSymLink() && srcFileInfo.isDir());
+                    namep += strlen (namep) + 1;
+                }
+               free (name_space);
             }
-           free (name_space);
 
             if (targetPath)
                 *targetPath = targetDir.absolutePath();
@@ -2492,7 +2555,7 @@ bool FileJob::checkDiskSpaceAvailable(const DUrlList &files, const DUrl &destina
 //    if(!info)
 //        info = deviceListener->getDeviceByFilePath(destination.path()); // get disk infor from mount mount point sub path
     if (FileUtils::isGvfsMountFile(destination.toLocalFile())){
-        m_totalSize = FileUtils::totalSize(files);
+        startTotalSizeScan(files);
         return true;
     }
 
@@ -2511,19 +2574,137 @@ bool FileJob::checkDiskSpaceAvailable(const DUrlList &files, const DUrl &destina
 
     m_checkDiskJobDataDetail = jobDataDetail;
 
-    //calculate files's sizes
-    m_totalSize = FileUtils::totalSize(files, freeBytes, isInLimit);
+    //calculate files's sizes, the listed directories are reused by copyDir
+    m_manifest.clear();
+    m_totalSize = scanSources(files, freeBytes, isInLimit, &m_manifest);
 
     jobDataDetail["status"] = "working";
 
     m_checkDiskJobDataDetail = jobDataDetail;
 
-    if(!isInLimit)
+    if(!isInLimit) {
+        m_manifest.clear();
         qDebug() << QString ("Can't copy or move files to target disk, disk free: %1").arg(FileUtils::formatSize(freeBytes));
+    }
 
     return isInLimit;
 }
 
+qint64 FileJob::scanSources(const DUrlList &files, qint64 maxLimit, bool &isInLimit, Manifest *manifest, const QAtomicInt *stop)
+{
+    // same as FileUtils::totalSize, the symlinks are not counted and the directories are
+    qint64 total = 1;
+    int manifestSize = 0;
+
+    for (const DUrl &url : files) {
+        const QString &path = url.toLocalFile();
+        struct stat st;
+
+        if (path.isEmpty() || stat(QFile::encodeName(path).constData(), &st) != 0)
+            continue;
+
+        if (S_ISREG(st.st_mode))
+            total += st.st_size;
+
+        if (total > maxLimit) {
+            isInLimit = false;
+            return total;
+        }
+
+        if (!S_ISDIR(st.st_mode))
+            continue;
+
+        QStringList dirs {path};
+
+        while (!dirs.isEmpty()) {
+            if (stop && stop->load())
+                return total;
+
+            const QString dirPath = dirs.takeLast();
+            DIR *dir = opendir(QFile::encodeName(dirPath).constData());
+
+            if (!dir)
+                continue;
+
+            QVector<ManifestEntry> entries;
+
+            while (struct dirent *ent = readdir(dir)) {
+                const char *name = ent->d_name;
+
+                if (name[name[0] != '.' ? 0 : name[1] != '.' ? 1 : 2] == '\0')
+                    continue;
+
+                if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                    continue;
+
+                if (!S_ISLNK(st.st_mode)) {
+                    total += st.st_size;
+
+                    if (total > maxLimit) {
+                        closedir(dir);
+                        isInLimit = false;
+                        return total;
+                    }
+                }
+
+                const QString &fileName = QFile::decodeName(name);
+
+                if (S_ISDIR(st.st_mode))
+                    dirs << QString("%1/%2").arg(dirPath, fileName);
+
+                if (manifest)
+                    entries << ManifestEntry {fileName, st.st_size, st.st_ino, st.st_mode};
+            }
+
+            closedir(dir);
+
+            // a directory is listed entirely or not at all
+            if (manifest && manifestSize + entries.size() <= MAX_MANIFEST_ENTRIES) {
+                // same order as savedir, the inodes are mostly laid out on the disk in this order
+                std::sort(entries.begin(), entries.end(), [] (const ManifestEntry &a, const ManifestEntry &b) {
+                    return a.inode < b.inode;
+                });
+
+                manifestSize += entries.size();
+                manifest->insert(dirPath, entries);
+            }
+        }
+    }
+
+    return total;
+}
+
+void FileJob::startTotalSizeScan(const DUrlList &files)
+{
+    QSharedPointer<QAtomicInt> stop(new QAtomicInt(0));
+
+    if (m_stopTotalSizeScan)
+        m_stopTotalSizeScan->store(1);
+
+    m_stopTotalSizeScan = stop;
+    // the copying doesn't wait for the counting, the total is taken by totalSizeReady
+    m_totalSize = std::numeric_limits<qint64>::max();
+    m_totalSizeFuture = QtConcurrent::run([files, stop] {
+        bool isInLimit = true;
+
+        return scanSources(files, std::numeric_limits<qint64>::max(), isInLimit, nullptr, stop.data());
+    });
+}
+
+bool FileJob::totalSizeReady()
+{
+    if (!m_totalSizeFuture.isFinished())
+        return false;
+
+    // a default constructed future is canceled, the total was taken already
+    if (!m_totalSizeFuture.isCanceled()) {
+        m_totalSize = m_totalSizeFuture.result();
+        m_totalSizeFuture = QFuture<qint64>();
+    }
+
+    return true;
+}
+
 bool FileJob::checkTrashFileOutOf1GB(const DUrl &url)
 {
     const QFileInfo &info(url.toLocalFile());
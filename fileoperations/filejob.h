@@ -29,7 +29,13 @@
 #include <QMap>
 #include <QElapsedTimer>
 #include <QUrl>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QHash>
+#include <QSharedPointer>
+#include <QVector>
 #include "durl.h"
+#include "dwritebackthrottle.h"
 #include <QStorageInfo>
 
 #define TRANSFER_RATE 5
@@ -187,6 +193,16 @@ public slots:
     void jobConflicted();
 
 private:
+    // an entry of the pre-scan of the sources
+    struct ManifestEntry {
+        QString name;
+        qint64 size;
+        quint64 inode;
+        quint32 mode;
+    };
+    // the children of the scanned directories, sorted by inode
+    typedef QHash<QString, QVector<ManifestEntry>> Manifest;
+
     Status m_status;
     QString m_trashLoc;
     QString m_id;
@@ -199,8 +215,15 @@ private:
 
     qint64 m_bytesCopied = 0;
     qint64 m_totalSize = 1;
+    // the total size is counted in background when the disk space isn't checked
+    QFuture<qint64> m_totalSizeFuture;
+    QSharedPointer<QAtomicInt> m_stopTotalSizeScan;
+    Manifest m_manifest;
     qint64 m_bytesPerSec = 0;
     qint64 m_last_current_num_bytes = 0;
+    // the dirty pages are limited when copying to a removable disk
+    DFM_NAMESPACE::DWriteBackThrottle m_writeBackThrottle;
+    bool m_throttleWriteBack = false;
 
     QString m_progress;
     float m_factor;
@@ -258,6 +281,10 @@ private:
     //check disk space available before do copy/move job
     bool checkDiskSpaceAvailable(const DUrlList& files, const DUrl& destination);
 
+    static qint64 scanSources(const DUrlList &files, qint64 maxLimit, bool &isInLimit, Manifest *manifest, const QAtomicInt *stop = nullptr);
+    void startTotalSizeScan(const DUrlList &files);
+    bool totalSizeReady();
+
     //check if is moving to trash file out of size range of 1GB;
     bool checkTrashFileOutOf1GB(const DUrl& url);
 
@@ -94,6 +94,7 @@ void UserShareManager::initConnect()
         handleShareChanged(to);
     });
     connect(m_shareInfosChangedTimer, &QTimer::timeout, this, [this](){emit updateUserShareInfo(true);});
+    connect(this, &UserShareManager::userShareCountChanged, fileSignalManager, &FileSignalManager::userShareCountChanged);
 //    connect(m_lazyStartSambaServiceTimer, &QTimer::timeout, this, &UserShareManager::initSamaServiceSettings);
 }
 